@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <GLFW/glfw3.h>
+
+#include <game/cell_kernels.h>
+#include <game/cell_traits.h>
+#include <game/flow_field.h>
+#include <game/map.h>
+#include <game/resource_counter.h>
+#include <game/world.h>
+
+#include <render/map_renderer.h>
+#include <render/projection.h>
+#include <render/render_queue.h>
+#include <render/shader.h>
+#include <render/sprite_batch.h>
+#include <render/sprites.h>
+#include <render/texture_atlas.h>
+
+/**
+ * The benchmark renders into an offscreen framebuffer of a hidden window, so results do not
+ * depend on the display, the window manager or vsync. Every case is run for a fixed amount
+ * of wall clock time and each frame ends with glFinish(), such that the measured frame time
+ * includes the GPU work of the frame.
+ */
+
+typedef std::chrono::steady_clock Clock;
+
+struct BenchmarkOptions {
+    std::vector<int> sizes = {10, 32, 64, 128, 256, 512, 1024, 2048, 4096};
+    double seconds = 1.0;
+    // the per-cell strategy issues one draw per cell, large maps would take minutes a frame
+    int per_cell_limit = 512;
+    // the sprite batch rebuilds every quad on the CPU each frame
+    int sprite_limit = 1024;
+    // baked geometry takes 72 bytes per cell, a 4096 map would need over a gigabyte
+    int baked_limit = 2048;
+    // the simulation case spawns a bullet per this many cells, at most simulation_bullets
+    int cells_per_bullet = 64;
+    int simulation_bullets = 10000;
+    int width = 1024;
+    int height = 1024;
+    std::string csv;
+    // scratch file for the level loading case
+    std::string level = "benchmark.level";
+};
+
+/**
+ * Every case counts the heap allocations made while it is measured. Cases that claim a
+ * steady state without allocations set allocation_free, the benchmark fails if they
+ * allocate anyway. Only allocations through operator new are seen, not those of the C
+ * libraries such as the GL driver.
+ */
+struct BenchmarkResult {
+    int size;
+    std::string name;
+    long frames;
+    double seconds;
+    int draw_calls;
+    long allocations;
+    bool allocation_free;
+    // GL memory the map renderer of a case holds, see render::MapRenderer::buffers
+    long long gpu_bytes;
+};
+
+std::atomic<long> heap_allocations(0);
+
+void *operator new(std::size_t size)
+{
+    ++heap_allocations;
+    if (void *memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+BenchmarkOptions parseBenchmarkOptions(int argc, char *argv[])
+{
+    BenchmarkOptions options;
+    for (int i=1; i<argc; ++i) {
+        if (std::strncmp(argv[i], "--sizes=", 8) == 0) {
+            options.sizes.clear();
+            std::istringstream list(argv[i] + 8);
+            std::string size;
+            while (std::getline(list, size, ',')) {
+                if (std::atoi(size.c_str()) > 0) {
+                    options.sizes.push_back(std::atoi(size.c_str()));
+                }
+            }
+        } else if (std::strncmp(argv[i], "--seconds=", 10) == 0 && std::atof(argv[i] + 10) > 0.0) {
+            options.seconds = std::atof(argv[i] + 10);
+        } else if (std::strncmp(argv[i], "--per-cell-limit=", 17) == 0) {
+            options.per_cell_limit = std::atoi(argv[i] + 17);
+        } else if (std::strncmp(argv[i], "--csv=", 6) == 0) {
+            options.csv = argv[i] + 6;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--sizes=N,N,...] [--seconds=S] [--per-cell-limit=N] [--csv=FILE]\n";
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+/**
+ * @brief fillPattern gives the map a mix of all cell types, such that the cell type buffer
+ * does not consist of a single repeated value
+ */
+void fillPattern(game::Map &map)
+{
+    const game::Map::CellType types[] = {
+        game::Map::Floor, game::Map::Clay, game::Map::Wall, game::Map::Rock, game::Map::Water
+    };
+    for (int i=0; i<map.row_count(); ++i) {
+        for (int j=0; j<map.col_count(); ++j) {
+            map.set_cell(i, j, types[(i * 7 + j * 3) % 5]);
+        }
+    }
+}
+
+/**
+ * @brief spawnEntities spreads bullets and a tenth as many tanks over the map of world
+ */
+void spawnEntities(game::World &world, int bullets)
+{
+    const int cols = world.map().col_count();
+    const int rows = world.map().row_count();
+    world.bullets().reserve(bullets);
+    world.tanks().reserve(bullets / 10 + 1);
+    for (int i=0; i<bullets; ++i) {
+        const game::Direction direction = static_cast<game::Direction>(i % 4);
+        world.bullets().spawn((i * 13) % cols + 0.5f, (i * 7) % rows + 0.5f, direction, 8.0f, 1);
+        if (i % 10 == 0) {
+            world.tanks().spawn((i * 3) % cols + 0.5f, (i * 11) % rows + 0.5f, direction, 2.0f, 3);
+        }
+    }
+}
+
+/**
+ * @brief benchmarkSimulation measures updates of world with the entities it holds
+ */
+BenchmarkResult benchmarkSimulation(game::World &world, double seconds)
+{
+    BenchmarkResult result = {world.map().row_count(), "simulation", 0, 0.0, 0, 0, false, 0};
+    result.allocation_free = true;
+    // the first tick sizes the scratch buffers of the world and is not measured
+    world.update();
+    const long allocations = heap_allocations;
+    const Clock::time_point start = Clock::now();
+    do {
+        world.update();
+        ++result.frames;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < seconds);
+    result.allocations = heap_allocations - allocations;
+    return result;
+}
+
+/**
+ * @brief benchmarkEntities measures world updates with the given number of bullets and a
+ * tenth as many tanks driving around, the size column of the result is the bullet count
+ */
+BenchmarkResult benchmarkEntities(int bullets, double seconds)
+{
+    game::World world(256);
+    spawnEntities(world, bullets);
+    BenchmarkResult result = benchmarkSimulation(world, seconds);
+    result.size = bullets;
+    result.name = "entities";
+    return result;
+}
+
+/**
+ * @brief benchmarkLoad saves the map as a binary level and measures how often it can be
+ * loaded again per second
+ */
+BenchmarkResult benchmarkLoad(const game::Map &map, const std::string &path, double seconds)
+{
+    BenchmarkResult result = {map.row_count(), "load", 0, 0.0, 0, 0, false, 0};
+    if (!map.save(path)) {
+        std::cerr << "could not write " << path << "\n";
+        return result;
+    }
+    const long allocations = heap_allocations;
+    const Clock::time_point start = Clock::now();
+    do {
+        std::unique_ptr<game::Map> level = game::Map::load(path);
+        if (!level) {
+            std::cerr << "could not load " << path << "\n";
+            break;
+        }
+        ++result.frames;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < seconds);
+    result.allocations = heap_allocations - allocations;
+    std::remove(path.c_str());
+    return result;
+}
+
+/**
+ * @brief benchmarkBulk measures one round of the bulk map operations over the whole map per
+ * frame: counting a type, replacing clay by water and back, and a diff against the original
+ */
+BenchmarkResult benchmarkBulk(const game::Map &map, double seconds)
+{
+    BenchmarkResult result = {map.row_count(), std::string("bulk ") + game::simdName(), 0, 0.0, 0, 0, false, 0};
+    result.allocation_free = true;
+    game::Map scratch(map);
+    std::vector<std::uint64_t> bits;
+    // sizes the diff bitmask before measuring
+    long checksum = scratch.diff(map, bits);
+    const long allocations = heap_allocations;
+    const Clock::time_point start = Clock::now();
+    do {
+        checksum += scratch.count(scratch.bounds(), game::Map::Wall);
+        checksum += scratch.replace(scratch.bounds(), game::Map::Clay, game::Map::Custom);
+        checksum += scratch.diff(map, bits);
+        checksum += scratch.replace(scratch.bounds(), game::Map::Custom, game::Map::Clay);
+        ++result.frames;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < seconds);
+    result.allocations = heap_allocations - allocations;
+    if (checksum < 0) {
+        std::cerr << "bulk operations failed\n";
+    }
+    return result;
+}
+
+/**
+ * @brief benchmarkNavigation destroys one clay cell per frame and measures the incremental
+ * update of a flow field towards the middle of the bottom row
+ */
+BenchmarkResult benchmarkNavigation(const game::Map &map, double seconds)
+{
+    BenchmarkResult result = {map.row_count(), "navigation", 0, 0.0, 0, 0, false, 0};
+    game::Map scratch(map);
+    game::FlowField field(scratch, 0, scratch.col_count() / 2);
+    int cursor = 0;
+    // the search queue grows with the largest area a single opened cell connects
+    const long allocations = heap_allocations;
+    const Clock::time_point start = Clock::now();
+    do {
+        for (; cursor < scratch.cell_count(); ++cursor) {
+            if (scratch.data()[cursor] == game::Map::Clay) {
+                scratch.set_cell(cursor / scratch.col_count(), cursor % scratch.col_count(), game::Map::Floor);
+                break;
+            }
+        }
+        field.update(scratch);
+        ++result.frames;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < seconds);
+    result.allocations = heap_allocations - allocations;
+    return result;
+}
+
+BenchmarkResult benchmarkRenderer(const game::Map &map, glm::mat4x4 &ortho,
+                                  render::MapRenderer::Mode mode, double seconds)
+{
+    render::MapRenderer renderer(map, ortho, mode);
+    render::RenderQueue queue;
+    BenchmarkResult result = {map.row_count(), render::MapRenderer::mode_name(mode), 0, 0.0, 0, 0, false, 0};
+    result.allocation_free = true;
+
+    // the first frame pays for lazy driver allocations and is not measured
+    glClear(GL_COLOR_BUFFER_BIT);
+    renderer.submit(queue);
+    queue.execute();
+    glFinish();
+
+    const long allocations = heap_allocations;
+    const Clock::time_point start = Clock::now();
+    do {
+        glClear(GL_COLOR_BUFFER_BIT);
+        renderer.submit(queue);
+        queue.execute();
+        glFinish();
+        ++result.frames;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < seconds || result.frames < 3);
+    result.allocations = heap_allocations - allocations;
+    result.draw_calls = renderer.draw_calls();
+    result.gpu_bytes = render::MapRenderer::buffers.bytes() + render::MapRenderer::textures.bytes();
+    return result;
+}
+
+/**
+ * @brief benchmarkSpriteBatch submits every cell as an individual sprite each frame, which
+ * measures the CPU cost of building and streaming a batch rather than the map renderers
+ */
+BenchmarkResult benchmarkSpriteBatch(const game::Map &map, const glm::mat4x4 &ortho,
+                                     render::SpriteBatch &batch, const render::TextureAtlas &atlas,
+                                     const render::SpriteSheet &sheet, double seconds)
+{
+    BenchmarkResult result = {map.row_count(), "sprites", 0, 0.0, 0, 0, false, 0};
+    result.allocation_free = true;
+    const float scale = 1.0f / std::max(map.row_count(), 1);
+    const glm::mat4 viewMatrix = ortho * glm::scale(glm::mat4(1.0f), glm::vec3(scale, scale, scale));
+    render::RenderQueue queue;
+    auto frame = [&] {
+        glClear(GL_COLOR_BUFFER_BIT);
+        batch.begin(viewMatrix);
+        for (int i=0; i<map.row_count(); ++i) {
+            for (int j=0; j<map.col_count(); ++j) {
+                const game::Map::CellType type = map.cell(i, j);
+                batch.draw(atlas, sheet.cells[type], 2.0f * j - map.col_count(), 2.0f * i - map.row_count(),
+                           2.0f, 2.0f, 0, static_cast<int>(game::cellProperties(type).layer));
+            }
+        }
+        batch.end(queue, 0);
+        queue.execute();
+        glFinish();
+    };
+    // the first frame grows the sprite and vertex lists of the batch and the queue to this map size
+    frame();
+    const long allocations = heap_allocations;
+    const Clock::time_point start = Clock::now();
+    do {
+        frame();
+        ++result.frames;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (result.seconds < seconds || result.frames < 3);
+    result.allocations = heap_allocations - allocations;
+    result.draw_calls = batch.draw_calls();
+    return result;
+}
+
+void printResult(const BenchmarkResult &result)
+{
+    const double frame_ms = result.frames > 0 ? 1000.0 * result.seconds / result.frames : 0.0;
+    std::cout << std::fixed << std::setprecision(3)
+              << std::setw(6) << result.size << std::setw(12) << result.name
+              << std::setw(10) << result.frames
+              << std::setw(14) << (result.seconds > 0.0 ? result.frames / result.seconds : 0.0)
+              << std::setw(12) << frame_ms << std::setw(10) << result.draw_calls
+              << std::setw(12) << (result.draw_calls > 0 ? 1000.0 * frame_ms / result.draw_calls : 0.0)
+              << std::setw(10) << result.allocations << std::setw(12) << result.gpu_bytes / 1024.0 << "\n";
+}
+
+bool writeCsv(const std::string &path, const std::vector<BenchmarkResult> &results)
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "size,case,frames,seconds,draw_calls,allocations,gpu_bytes\n";
+    for (const BenchmarkResult &result : results) {
+        out << result.size << ',' << result.name << ',' << result.frames << ','
+            << result.seconds << ',' << result.draw_calls << ',' << result.allocations << ','
+            << result.gpu_bytes << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkOptions options = parseBenchmarkOptions(argc, argv);
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "BattleCity benchmark", nullptr, nullptr);
+    if (window == nullptr) {
+        std::cerr << "could not create an OpenGL 3.3 context\n";
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    glewExperimental = GL_TRUE;
+    glewInit();
+
+    GLuint framebuffer;
+    GLuint colorbuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &colorbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "offscreen framebuffer is incomplete\n";
+        glfwTerminate();
+        return 1;
+    }
+    glViewport(0, 0, options.width, options.height);
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+    glm::mat4x4 ortho = render::computeOrthoMatrix(options.width, options.height);
+    const render::MapRenderer::Mode modes[] = {
+        render::MapRenderer::PerCell,
+        render::MapRenderer::Instanced,
+        render::MapRenderer::Chunked,
+        render::MapRenderer::Tilemap,
+        render::MapRenderer::Baked
+    };
+
+    std::cout << std::setw(6) << "size" << std::setw(12) << "case" << std::setw(10) << "frames"
+              << std::setw(14) << "per second" << std::setw(12) << "ms/frame" << std::setw(10) << "draws"
+              << std::setw(12) << "us/draw" << std::setw(10) << "allocs" << std::setw(12) << "GPU KiB" << std::endl;
+    render::TextureAtlas atlas(256, 256);
+    const render::SpriteSheet sheet = render::buildSpriteSheet(atlas);
+    render::SpriteBatch batch;
+
+    std::vector<BenchmarkResult> results;
+    for (int size : options.sizes) {
+        game::World world(size);
+        fillPattern(world.map());
+
+        {
+            // the simulation runs on a copy, its bullets destroy clay of the map the later cases use
+            game::World simulated(world.map());
+            spawnEntities(simulated, std::min(std::max(size * size / options.cells_per_bullet, 1),
+                                              options.simulation_bullets));
+            results.push_back(benchmarkSimulation(simulated, options.seconds));
+            printResult(results.back());
+        }
+        results.push_back(benchmarkLoad(world.map(), options.level, options.seconds));
+        printResult(results.back());
+        results.push_back(benchmarkBulk(world.map(), options.seconds));
+        printResult(results.back());
+        results.push_back(benchmarkNavigation(world.map(), options.seconds));
+        printResult(results.back());
+
+        for (render::MapRenderer::Mode mode : modes) {
+            if ((mode == render::MapRenderer::PerCell && size > options.per_cell_limit)
+                    || (mode == render::MapRenderer::Baked && size > options.baked_limit)) {
+                continue;
+            }
+            results.push_back(benchmarkRenderer(world.map(), ortho, mode, options.seconds));
+            printResult(results.back());
+        }
+        if (size <= options.sprite_limit) {
+            results.push_back(benchmarkSpriteBatch(world.map(), ortho, batch, atlas, sheet, options.seconds));
+            printResult(results.back());
+        }
+        std::cout.flush();
+    }
+
+    for (int bullets : {100, 1000, 10000, 100000}) {
+        results.push_back(benchmarkEntities(bullets, options.seconds));
+        printResult(results.back());
+    }
+
+    if (!options.csv.empty() && !writeCsv(options.csv, results)) {
+        std::cerr << "could not write results to " << options.csv << "\n";
+    }
+
+    int exit_code = 0;
+    for (const BenchmarkResult &result : results) {
+        if (result.allocation_free && result.allocations > 0) {
+            std::cerr << result.name << " at size " << result.size << " allocated " << result.allocations
+                      << " times in its steady state\n";
+            exit_code = 1;
+        }
+    }
+    std::cout << "\n";
+    game::printResourceCounters(std::cout);
+    // every renderer of a case is gone, anything left is a leak
+    const game::ResourceCounter *leak_checked[] = {
+        &render::MapRenderer::buffers, &render::MapRenderer::textures, &render::MapRenderer::vertex_arrays,
+        &render::Program::attachments
+    };
+    for (const game::ResourceCounter *counter : leak_checked) {
+        if (counter->objects() != 0) {
+            std::cerr << counter->objects() << " " << counter->name() << " are still alive\n";
+            exit_code = 1;
+        }
+    }
+
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorbuffer);
+    glfwTerminate();
+    return exit_code;
+}
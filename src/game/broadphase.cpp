@@ -0,0 +1,161 @@
+#include "broadphase.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace game;
+
+namespace {
+
+// tolerance in cells for boxes that were stopped at a cell boundary with rounding errors,
+// so they neither tunnel into the cell nor get caught by it when sliding along it
+constexpr float skin = 1e-4f;
+
+/**
+ * @brief slab computes when a point moving by d along one axis enters and leaves [low, high]
+ * @return the entry and exit times; if the point does not move they are -inf and +inf
+ * when it is inside, +inf and -inf otherwise
+ */
+std::pair<float, float> slab(float position, float d, float low, float high)
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+    if (d == 0.0f) {
+        if (position > low + skin && position < high - skin) {
+            return std::make_pair(-infinity, infinity);
+        }
+        return std::make_pair(infinity, -infinity);
+    }
+    const float t0 = (low - position) / d;
+    const float t1 = (high - position) / d;
+    return std::make_pair(std::min(t0, t1), std::max(t0, t1));
+}
+
+}
+
+Sweep game::sweep(const Map &map, const Aabb &box, float dx, float dy, Collider collider)
+{
+    Sweep result = {1.0f, -1, -1};
+    if (dx == 0.0f && dy == 0.0f) {
+        return result;
+    }
+    const float half_x = (box.max_x - box.min_x) / 2;
+    const float half_y = (box.max_y - box.min_y) / 2;
+    const float center_x = box.min_x + half_x;
+    const float center_y = box.min_y + half_y;
+
+    const float tolerance = skin / std::max(std::abs(dx), std::abs(dy));
+    const int col_begin = static_cast<int>(std::floor(std::min(box.min_x, box.min_x + dx)));
+    const int col_end = static_cast<int>(std::ceil(std::max(box.max_x, box.max_x + dx)));
+    const int row_begin = static_cast<int>(std::floor(std::min(box.min_y, box.min_y + dy)));
+    const int row_end = static_cast<int>(std::ceil(std::max(box.max_y, box.max_y + dy)));
+    for (int row=row_begin; row<row_end; ++row) {
+        for (int col=col_begin; col<col_end; ++col) {
+            if (!solidAt(map, row, col, collider)) {
+                continue;
+            }
+            // the cell grown by the half size of the box, against the path of its center
+            const std::pair<float, float> x = slab(center_x, dx, col - half_x, col + 1 + half_x);
+            const std::pair<float, float> y = slab(center_y, dy, row - half_y, row + 1 + half_y);
+            const float entry = std::max(x.first, y.first);
+            const float exit = std::min(x.second, y.second);
+            if (entry < exit && entry >= -tolerance && entry < result.time) {
+                result.time = std::max(entry, 0.0f);
+                result.row = row;
+                result.col = col;
+            }
+        }
+    }
+    return result;
+}
+
+SpatialHash::SpatialHash(float cell_size)
+    : inverse_cell_size_(1.0f / cell_size),
+      bucket_count_(1),
+      bucket_start_(2, 0)
+{
+}
+
+void SpatialHash::clear()
+{
+    items_.clear();
+    entries_.clear();
+}
+
+void SpatialHash::insert(std::uint32_t user, const Aabb &box)
+{
+    Item item = {user, box};
+    items_.push_back(item);
+}
+
+void SpatialHash::build()
+{
+    // collect one entry per covered cell, then counting sort the entries by bucket
+    std::size_t cell_count = 0;
+    // the most cells boxes of these sizes can cover wherever they are, sizing the buffers by
+    // it keeps them from growing while the boxes move
+    std::size_t cell_bound = 0;
+    for (const Item &item : items_) {
+        cell_count += static_cast<std::size_t>(cell_of(item.box.max_x) - cell_of(item.box.min_x) + 1)
+                * (cell_of(item.box.max_y) - cell_of(item.box.min_y) + 1);
+        cell_bound += static_cast<std::size_t>(std::floor((item.box.max_x - item.box.min_x) * inverse_cell_size_) + 2)
+                * static_cast<std::size_t>(std::floor((item.box.max_y - item.box.min_y) * inverse_cell_size_) + 2);
+    }
+    bucket_count_ = 1;
+    while (bucket_count_ < 2 * cell_bound) {
+        bucket_count_ *= 2;
+    }
+    bucket_start_.assign(bucket_count_ + 1, 0);
+    entries_.reserve(cell_bound);
+    entries_.resize(cell_count);
+
+    for (const Item &item : items_) {
+        for (int cell_y=cell_of(item.box.min_y); cell_y<=cell_of(item.box.max_y); ++cell_y) {
+            for (int cell_x=cell_of(item.box.min_x); cell_x<=cell_of(item.box.max_x); ++cell_x) {
+                ++bucket_start_[bucket_of(cell_x, cell_y) + 1];
+            }
+        }
+    }
+    for (std::size_t bucket=0; bucket<bucket_count_; ++bucket) {
+        bucket_start_[bucket + 1] += bucket_start_[bucket];
+    }
+    // bucket_start_[b + 1] is used as fill cursor of bucket b and ends up at its end again
+    std::vector<std::uint32_t> &cursor = bucket_start_;
+    for (std::uint32_t i=0; i<items_.size(); ++i) {
+        const Aabb &box = items_[i].box;
+        for (int cell_y=cell_of(box.min_y); cell_y<=cell_of(box.max_y); ++cell_y) {
+            for (int cell_x=cell_of(box.min_x); cell_x<=cell_of(box.max_x); ++cell_x) {
+                const std::size_t bucket = bucket_of(cell_x, cell_y);
+                Entry entry = {i, cell_x, cell_y};
+                entries_[cursor[bucket]++] = entry;
+            }
+        }
+    }
+    // the fill moved every start to the start of the next bucket, shift them back
+    for (std::size_t bucket=bucket_count_; bucket>0; --bucket) {
+        bucket_start_[bucket] = bucket_start_[bucket - 1];
+    }
+    bucket_start_[0] = 0;
+}
+
+void SpatialHash::find_pairs(std::vector<Pair> &pairs) const
+{
+    for (std::size_t bucket=0; bucket<bucket_count_; ++bucket) {
+        for (std::uint32_t i=bucket_start_[bucket]; i<bucket_start_[bucket + 1]; ++i) {
+            const Entry &a = entries_[i];
+            const Aabb &box_a = items_[a.item].box;
+            for (std::uint32_t j=i + 1; j<bucket_start_[bucket + 1]; ++j) {
+                const Entry &b = entries_[j];
+                const Aabb &box_b = items_[b.item].box;
+                if (a.cell_x != b.cell_x || a.cell_y != b.cell_y || !overlaps(box_a, box_b)) {
+                    continue;
+                }
+                // report the pair from the cell holding the lower left corner of the overlap
+                if (cell_of(std::max(box_a.min_x, box_b.min_x)) != a.cell_x
+                        || cell_of(std::max(box_a.min_y, box_b.min_y)) != a.cell_y) {
+                    continue;
+                }
+                pairs.push_back(std::make_pair(items_[a.item].user, items_[b.item].user));
+            }
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "cell_traits.h"
+#include "map.h"
+
+namespace game {
+
+    /**
+     * @brief The Aabb struct is an axis aligned box in cell units, see EntityStore
+     */
+    struct Aabb {
+        float min_x;
+        float min_y;
+        float max_x;
+        float max_y;
+    };
+
+    inline Aabb boxAround(float center_x, float center_y, float half_size)
+    {
+        Aabb box = {center_x - half_size, center_y - half_size, center_x + half_size, center_y + half_size};
+        return box;
+    }
+
+    /**
+     * @brief overlaps tells whether two boxes intersect, boxes that only touch do not
+     */
+    inline bool overlaps(const Aabb &a, const Aabb &b)
+    {
+        return a.min_x < b.max_x && b.min_x < a.max_x && a.min_y < b.max_y && b.min_y < a.max_y;
+    }
+
+    /**
+     * @brief solidAt looks up whether a cell stops a collider, cells outside the map are the
+     * arena border and always solid
+     */
+    inline bool solidAt(const Map &map, int row, int col, Collider collider)
+    {
+        if (row < 0 || col < 0 || row >= map.row_count() || col >= map.col_count()) {
+            return true;
+        }
+        return blocks(collider, map.cell(row, col));
+    }
+
+    /**
+     * @brief The Sweep struct is the result of moving a box through the map
+     */
+    struct Sweep {
+        // fraction of the displacement that can be travelled before touching a solid cell
+        float time;
+        // the cell that was hit, only meaningful if time < 1
+        int row;
+        int col;
+    };
+
+    /**
+     * @brief sweep moves a box by (dx, dy) and finds the first solid cell it runs into
+     *
+     * Only the cells covered by the swept box are visited, so the cost depends on the length
+     * of the movement and not on the size of the map. Cells the box already overlaps at the
+     * start are ignored, such that a stuck box can always move out.
+     */
+    Sweep sweep(const Map &map, const Aabb &box, float dx, float dy, Collider collider);
+
+    /**
+     * @brief The SpatialHash class finds overlapping boxes in time proportional to their number
+     *
+     * Boxes are inserted with a user value, build() sorts them into hash buckets of grid cells
+     * of cell_size with a counting sort, and queries only look at the buckets of the cells they
+     * cover. The bucket count follows the number of boxes, so neither memory nor the cost of a
+     * rebuild depends on the size of the map.
+     */
+    class SpatialHash
+    {
+    public:
+        typedef std::pair<std::uint32_t, std::uint32_t> Pair;
+
+        explicit SpatialHash(float cell_size = 1.0f);
+
+        void clear();
+        void insert(std::uint32_t user, const Aabb &box);
+
+        /**
+         * @brief build makes the boxes inserted since clear() available to queries
+         */
+        void build();
+
+        /**
+         * @brief query calls visit(user) once for every box overlapping the given box
+         */
+        template <typename Visitor>
+        void query(const Aabb &box, Visitor visit) const;
+
+        /**
+         * @brief find_pairs appends every pair of overlapping boxes once, as user values
+         */
+        void find_pairs(std::vector<Pair> &pairs) const;
+
+    private:
+        struct Item {
+            std::uint32_t user;
+            Aabb box;
+        };
+
+        struct Entry {
+            std::uint32_t item;
+            int cell_x;
+            int cell_y;
+        };
+
+        int cell_of(float coordinate) const {
+            return static_cast<int>(std::floor(coordinate * inverse_cell_size_));
+        }
+        std::size_t bucket_of(int cell_x, int cell_y) const {
+            const std::uint32_t hash = static_cast<std::uint32_t>(cell_x) * 73856093u
+                    ^ static_cast<std::uint32_t>(cell_y) * 19349663u;
+            return hash & (bucket_count_ - 1);
+        }
+
+        float inverse_cell_size_;
+        std::size_t bucket_count_;
+        std::vector<Item> items_;
+        std::vector<Entry> entries_;
+        std::vector<std::uint32_t> bucket_start_;
+    };
+
+    template <typename Visitor>
+    void SpatialHash::query(const Aabb &box, Visitor visit) const
+    {
+        if (entries_.empty()) {
+            return;
+        }
+        for (int cell_y=cell_of(box.min_y); cell_y<=cell_of(box.max_y); ++cell_y) {
+            for (int cell_x=cell_of(box.min_x); cell_x<=cell_of(box.max_x); ++cell_x) {
+                const std::size_t bucket = bucket_of(cell_x, cell_y);
+                for (std::uint32_t i=bucket_start_[bucket]; i<bucket_start_[bucket + 1]; ++i) {
+                    const Entry &entry = entries_[i];
+                    const Item &item = items_[entry.item];
+                    if (entry.cell_x != cell_x || entry.cell_y != cell_y || !overlaps(item.box, box)) {
+                        continue;
+                    }
+                    // boxes spanning several cells are reported from the cell holding the
+                    // lower left corner of the overlap only
+                    if (cell_of(std::max(item.box.min_x, box.min_x)) != cell_x
+                            || cell_of(std::max(item.box.min_y, box.min_y)) != cell_y) {
+                        continue;
+                    }
+                    visit(item.user);
+                }
+            }
+        }
+    }
+
+}
+
+#endif // BROADPHASE_H
@@ -0,0 +1,152 @@
+#ifndef BYTE_STREAM_H
+#define BYTE_STREAM_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace game {
+
+    /**
+     * @brief The ByteWriter class appends little endian values to a byte buffer
+     *
+     * Unsigned integers can also be written as varints, seven bits per byte with the high
+     * bit set on all but the last byte, so small values such as counts take a single byte.
+     */
+    class ByteWriter
+    {
+    public:
+        explicit ByteWriter(std::vector<std::uint8_t> &bytes)
+            : bytes_(bytes)
+        {
+        }
+
+        void u8(std::uint8_t value) {
+            bytes_.push_back(value);
+        }
+        void u16(std::uint16_t value) {
+            u8(static_cast<std::uint8_t>(value));
+            u8(static_cast<std::uint8_t>(value >> 8));
+        }
+        void u32(std::uint32_t value) {
+            u16(static_cast<std::uint16_t>(value));
+            u16(static_cast<std::uint16_t>(value >> 16));
+        }
+        void u64(std::uint64_t value) {
+            u32(static_cast<std::uint32_t>(value));
+            u32(static_cast<std::uint32_t>(value >> 32));
+        }
+        void f32(float value) {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            u32(bits);
+        }
+        void varint(std::uint64_t value) {
+            while (value >= 0x80) {
+                u8(static_cast<std::uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            u8(static_cast<std::uint8_t>(value));
+        }
+        void bytes(const void *data, std::size_t size) {
+            const std::uint8_t *begin = static_cast<const std::uint8_t*>(data);
+            bytes_.insert(bytes_.end(), begin, begin + size);
+        }
+
+        std::size_t size() const {
+            return bytes_.size();
+        }
+    private:
+        std::vector<std::uint8_t> &bytes_;
+    };
+
+    /**
+     * @brief The ByteReader class reads what ByteWriter wrote
+     *
+     * Reading past the end yields zeros and clears ok(), so a message can be decoded
+     * completely and validated once at the end.
+     */
+    class ByteReader
+    {
+    public:
+        ByteReader(const std::uint8_t *data, std::size_t size)
+            : cursor_(data),
+              end_(data + size),
+              ok_(true)
+        {
+        }
+
+        std::uint8_t u8() {
+            if (cursor_ == end_) {
+                ok_ = false;
+                return 0;
+            }
+            return *cursor_++;
+        }
+        std::uint16_t u16() {
+            const std::uint16_t low = u8();
+            return static_cast<std::uint16_t>(low | (u8() << 8));
+        }
+        std::uint32_t u32() {
+            const std::uint32_t low = u16();
+            return low | (static_cast<std::uint32_t>(u16()) << 16);
+        }
+        std::uint64_t u64() {
+            const std::uint64_t low = u32();
+            return low | (static_cast<std::uint64_t>(u32()) << 32);
+        }
+        float f32() {
+            const std::uint32_t bits = u32();
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        std::uint64_t varint() {
+            std::uint64_t value = 0;
+            for (int shift=0; shift<64; shift+=7) {
+                const std::uint8_t byte = u8();
+                value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            ok_ = false;
+            return 0;
+        }
+        bool bytes(void *data, std::size_t size) {
+            if (static_cast<std::size_t>(end_ - cursor_) < size) {
+                ok_ = false;
+                return false;
+            }
+            if (size == 0) {
+                return true;
+            }
+            std::memcpy(data, cursor_, size);
+            cursor_ += size;
+            return true;
+        }
+
+        bool ok() const {
+            return ok_;
+        }
+        /**
+         * @brief fail marks the data as invalid, for checks the reader cannot make itself
+         */
+        void fail() {
+            ok_ = false;
+        }
+        bool at_end() const {
+            return cursor_ == end_;
+        }
+        std::size_t remaining() const {
+            return static_cast<std::size_t>(end_ - cursor_);
+        }
+    private:
+        const std::uint8_t *cursor_;
+        const std::uint8_t *end_;
+        bool ok_;
+    };
+
+}
+
+#endif // BYTE_STREAM_H
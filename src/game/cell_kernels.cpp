@@ -0,0 +1,183 @@
+#include "cell_kernels.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BATTLECITY_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BATTLECITY_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BATTLECITY_NEON
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace game;
+
+namespace {
+
+inline unsigned popcount(std::uint32_t bits)
+{
+#if defined(_MSC_VER)
+    return __popcnt(bits);
+#else
+    return __builtin_popcount(bits);
+#endif
+}
+
+#if defined(BATTLECITY_NEON)
+/**
+ * @brief movemask packs the top bit of every byte into a 16 bit mask like _mm_movemask_epi8
+ */
+inline std::uint32_t movemask(uint8x16_t mask)
+{
+    static const std::uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(mask, vld1q_u8(weights));
+    return vaddv_u8(vget_low_u8(bits)) | (static_cast<std::uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+#endif
+
+}
+
+const char *game::simdName()
+{
+#if defined(BATTLECITY_AVX2)
+    return "avx2";
+#elif defined(BATTLECITY_SSE2)
+    return "sse2";
+#elif defined(BATTLECITY_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+std::size_t game::countCells(const std::uint8_t *cells, std::size_t count, std::uint8_t value)
+{
+    std::size_t result = 0;
+    std::size_t i = 0;
+#if defined(BATTLECITY_AVX2)
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(value));
+    for (; i + 32 <= count; i += 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + i));
+        result += popcount(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle))));
+    }
+#elif defined(BATTLECITY_SSE2)
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(value));
+    for (; i + 16 <= count; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+        result += popcount(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle))));
+    }
+#elif defined(BATTLECITY_NEON)
+    const uint8x16_t needle = vdupq_n_u8(value);
+    const uint8x16_t one = vdupq_n_u8(1);
+    for (; i + 16 <= count; i += 16) {
+        result += vaddvq_u8(vandq_u8(vceqq_u8(vld1q_u8(cells + i), needle), one));
+    }
+#endif
+    for (; i < count; ++i) {
+        result += cells[i] == value;
+    }
+    return result;
+}
+
+std::size_t game::replaceCells(std::uint8_t *cells, std::size_t count, std::uint8_t from, std::uint8_t to)
+{
+    std::size_t result = 0;
+    std::size_t i = 0;
+#if defined(BATTLECITY_AVX2)
+    const __m256i needle = _mm256_set1_epi8(static_cast<char>(from));
+    const __m256i replacement = _mm256_set1_epi8(static_cast<char>(to));
+    for (; i + 32 <= count; i += 32) {
+        __m256i *address = reinterpret_cast<__m256i*>(cells + i);
+        const __m256i block = _mm256_loadu_si256(address);
+        const __m256i mask = _mm256_cmpeq_epi8(block, needle);
+        const std::uint32_t bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(mask));
+        if (bits != 0) {
+            _mm256_storeu_si256(address, _mm256_blendv_epi8(block, replacement, mask));
+            result += popcount(bits);
+        }
+    }
+#elif defined(BATTLECITY_SSE2)
+    const __m128i needle = _mm_set1_epi8(static_cast<char>(from));
+    const __m128i replacement = _mm_set1_epi8(static_cast<char>(to));
+    for (; i + 16 <= count; i += 16) {
+        __m128i *address = reinterpret_cast<__m128i*>(cells + i);
+        const __m128i block = _mm_loadu_si128(address);
+        const __m128i mask = _mm_cmpeq_epi8(block, needle);
+        const std::uint32_t bits = static_cast<std::uint32_t>(_mm_movemask_epi8(mask));
+        if (bits != 0) {
+            _mm_storeu_si128(address, _mm_or_si128(_mm_andnot_si128(mask, block), _mm_and_si128(mask, replacement)));
+            result += popcount(bits);
+        }
+    }
+#elif defined(BATTLECITY_NEON)
+    const uint8x16_t needle = vdupq_n_u8(from);
+    const uint8x16_t replacement = vdupq_n_u8(to);
+    const uint8x16_t one = vdupq_n_u8(1);
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16_t block = vld1q_u8(cells + i);
+        const uint8x16_t mask = vceqq_u8(block, needle);
+        const unsigned replaced = vaddvq_u8(vandq_u8(mask, one));
+        if (replaced != 0) {
+            vst1q_u8(cells + i, vbslq_u8(mask, replacement, block));
+            result += replaced;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        if (cells[i] == from) {
+            cells[i] = to;
+            ++result;
+        }
+    }
+    return result;
+}
+
+std::size_t game::diffCells(const std::uint8_t *a, const std::uint8_t *b, std::size_t count, std::uint64_t *bits)
+{
+    std::memset(bits, 0, (count + 63) / 64 * sizeof(std::uint64_t));
+    std::size_t result = 0;
+    std::size_t i = 0;
+#if defined(BATTLECITY_AVX2)
+    for (; i + 64 <= count; i += 64) {
+        std::uint64_t word = 0;
+        for (int half=0; half<2; ++half) {
+            const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + half * 32));
+            const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + half * 32));
+            const std::uint32_t equal = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(left, right)));
+            word |= static_cast<std::uint64_t>(~equal) << (half * 32);
+        }
+        bits[i / 64] = word;
+        result += popcount(static_cast<std::uint32_t>(word)) + popcount(static_cast<std::uint32_t>(word >> 32));
+    }
+#elif defined(BATTLECITY_SSE2) || defined(BATTLECITY_NEON)
+    for (; i + 64 <= count; i += 64) {
+        std::uint64_t word = 0;
+        for (int quarter=0; quarter<4; ++quarter) {
+#if defined(BATTLECITY_SSE2)
+            const __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + quarter * 16));
+            const __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + quarter * 16));
+            const std::uint32_t equal = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)));
+#else
+            const std::uint32_t equal = movemask(vceqq_u8(vld1q_u8(a + i + quarter * 16), vld1q_u8(b + i + quarter * 16)));
+#endif
+            word |= static_cast<std::uint64_t>(~equal & 0xffffu) << (quarter * 16);
+        }
+        bits[i / 64] = word;
+        result += popcount(static_cast<std::uint32_t>(word)) + popcount(static_cast<std::uint32_t>(word >> 32));
+    }
+#endif
+    for (; i < count; ++i) {
+        if (a[i] != b[i]) {
+            bits[i / 64] |= std::uint64_t(1) << (i % 64);
+            ++result;
+        }
+    }
+    return result;
+}
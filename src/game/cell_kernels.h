@@ -0,0 +1,43 @@
+#ifndef CELL_KERNELS_H
+#define CELL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace game {
+
+    /**
+     * The cell kernels are the inner loops of the bulk operations of Map, working on spans of
+     * one byte cells. They compare and blend 32 cells per instruction with AVX2, 16 with SSE2
+     * or NEON, and fall back to scalar code on other targets or for the tail of a span.
+     * SSE2 is part of every x86-64 target, AVX2 is used if the compiler targets it, e.g. with
+     * the BATTLECITY_NATIVE build option.
+     */
+
+    /**
+     * @brief simdName names the instruction set the kernels were compiled for
+     */
+    const char *simdName();
+
+    /**
+     * @brief countCells counts the cells in [cells, cells + count) equal to value
+     */
+    std::size_t countCells(const std::uint8_t *cells, std::size_t count, std::uint8_t value);
+
+    /**
+     * @brief replaceCells changes every cell equal to from into to
+     * @return the number of cells that were replaced
+     */
+    std::size_t replaceCells(std::uint8_t *cells, std::size_t count, std::uint8_t from, std::uint8_t to);
+
+    /**
+     * @brief diffCells sets bit i % 64 of bits[i / 64] if a[i] != b[i] and clears it otherwise
+     *
+     * bits must have room for (count + 63) / 64 words, unused bits of the last word are cleared.
+     * @return the number of differing cells
+     */
+    std::size_t diffCells(const std::uint8_t *a, const std::uint8_t *b, std::size_t count, std::uint64_t *bits);
+
+}
+
+#endif // CELL_KERNELS_H
@@ -0,0 +1,20 @@
+#include "cell_traits.h"
+
+using namespace game;
+
+constexpr int CellTable::builtin_count;
+constexpr int CellTable::custom_count;
+constexpr CellProperties CellTable::builtin[];
+
+// zero initialized entries block nothing and cannot be destroyed, like floor
+CellProperties CellTable::custom[CellTable::custom_count];
+const CellProperties *const CellTable::pages[2] = {CellTable::builtin, CellTable::custom};
+
+bool game::defineCustomCell(Map::CellType type, const CellProperties &properties)
+{
+    if (type < Map::Custom) {
+        return false;
+    }
+    CellTable::custom[type - Map::Custom] = properties;
+    return true;
+}
@@ -0,0 +1,146 @@
+#ifndef CELL_TRAITS_H
+#define CELL_TRAITS_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "map.h"
+
+namespace game {
+
+    /**
+     * @brief The Collider enum names what is moving, cells block colliders differently
+     */
+    enum class Collider {
+        Tank,
+        Bullet
+    };
+
+    /**
+     * @brief The CellLayer enum tells whether a cell is drawn below or above the entities
+     */
+    enum class CellLayer : std::uint8_t {
+        Ground,
+        Overlay
+    };
+
+    /**
+     * @brief The CellProperties struct is everything the game needs to know about a cell type
+     *
+     * It is four bytes, so a lookup is a single load from CellTable.
+     */
+    struct CellProperties {
+        // bit i is set if the cell stops Collider i
+        std::uint8_t blocked;
+        // whether a bullet hitting the cell destroys it
+        bool destructible;
+        CellLayer layer;
+        // the cell type a destroyed cell leaves behind
+        Map::CellType debris;
+    };
+
+    constexpr std::uint8_t blocking(bool tank, bool bullet)
+    {
+        return static_cast<std::uint8_t>((tank ? 1 << static_cast<int>(Collider::Tank) : 0)
+                                         | (bullet ? 1 << static_cast<int>(Collider::Bullet) : 0));
+    }
+
+    /**
+     * @brief The CellTraits struct gives the properties of a cell type at compile time
+     *
+     * Types without a specialization, which includes unknown types a level file may hold,
+     * behave like floor.
+     */
+    template <Map::CellType Type>
+    struct CellTraits {
+        static constexpr CellProperties properties() {
+            return CellProperties{blocking(false, false), false, CellLayer::Ground, Type};
+        }
+    };
+
+    template <>
+    struct CellTraits<Map::Clay> {
+        static constexpr CellProperties properties() {
+            return CellProperties{blocking(true, true), true, CellLayer::Ground, Map::Floor};
+        }
+    };
+
+    template <>
+    struct CellTraits<Map::Wall> {
+        static constexpr CellProperties properties() {
+            return CellProperties{blocking(true, true), false, CellLayer::Ground, Map::Wall};
+        }
+    };
+
+    template <>
+    struct CellTraits<Map::Rock> {
+        static constexpr CellProperties properties() {
+            return CellProperties{blocking(true, true), false, CellLayer::Ground, Map::Rock};
+        }
+    };
+
+    // tanks cannot cross water while bullets fly over it
+    template <>
+    struct CellTraits<Map::Water> {
+        static constexpr CellProperties properties() {
+            return CellProperties{blocking(true, false), false, CellLayer::Ground, Map::Water};
+        }
+    };
+
+    /**
+     * @brief The CellTable struct holds the properties of all cell types for lookups at run time
+     *
+     * builtin is generated from the CellTraits of the named types and ends with one entry that
+     * all unnamed types below Map::Custom share, so it stays as small as the enum. The range
+     * from Map::Custom on has a table of its own, which defineCustomCell() fills in. pages holds
+     * both tables, indexed by the top bit of the type.
+     */
+    struct CellTable {
+        static_assert(Map::Custom == 128, "the custom range has to start at the top bit of a cell");
+
+        static constexpr int builtin_count = Map::Water + 1;
+        static constexpr int custom_count = 256 - Map::Custom;
+
+        static constexpr CellProperties builtin[builtin_count + 1] = {
+            CellTraits<Map::Floor>::properties(),
+            CellTraits<Map::Clay>::properties(),
+            CellTraits<Map::Wall>::properties(),
+            CellTraits<Map::Rock>::properties(),
+            CellTraits<Map::Water>::properties(),
+            CellTraits<static_cast<Map::CellType>(builtin_count)>::properties()
+        };
+        static CellProperties custom[custom_count];
+        static const CellProperties *const pages[2];
+    };
+
+    /**
+     * @brief cellProperties looks up the properties of a cell type, the table is selected and
+     * the index clamped without a branch
+     */
+    inline const CellProperties &cellProperties(Map::CellType type)
+    {
+        const int page = type >> 7;
+        const int last = CellTable::builtin_count + page * (CellTable::custom_count - 1 - CellTable::builtin_count);
+        return CellTable::pages[page][std::min<int>(type & (Map::Custom - 1), last)];
+    }
+
+    /**
+     * @brief defineCustomCell sets the properties of a type from the Map::Custom range
+     *
+     * Custom types behave like floor until they are defined. Definitions are global and have to
+     * be made before any simulation runs, peers of a networked match need the same ones.
+     * @return false if the type is not a custom type
+     */
+    bool defineCustomCell(Map::CellType type, const CellProperties &properties);
+
+    /**
+     * @brief blocks tells whether a cell type stops a collider
+     */
+    inline bool blocks(Collider collider, Map::CellType type)
+    {
+        return (cellProperties(type).blocked >> static_cast<int>(collider)) & 1;
+    }
+
+}
+
+#endif // CELL_TRAITS_H
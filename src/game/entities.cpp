@@ -0,0 +1,212 @@
+#include "entities.h"
+
+#include "byte_stream.h"
+
+using namespace game;
+
+constexpr EntityStore::Id EntityStore::invalid_id;
+constexpr int EntityStore::slot_bits;
+constexpr EntityStore::Id EntityStore::slot_mask;
+ResourceCounter EntityStore::memory("entities");
+
+namespace {
+
+const float direction_x[] = {0.0f, 1.0f, 0.0f, -1.0f};
+const float direction_y[] = {1.0f, 0.0f, -1.0f, 0.0f};
+
+template <typename Column>
+void removeAt(Column &column, int index)
+{
+    column[index] = column.back();
+    column.pop_back();
+}
+
+template <typename T, typename Allocator>
+void writeColumn(ByteWriter &out, const std::vector<T, Allocator> &column)
+{
+    out.bytes(column.data(), column.size() * sizeof(T));
+}
+
+template <typename T, typename Allocator>
+void readColumn(ByteReader &in, std::vector<T, Allocator> &column, std::size_t size)
+{
+    // comparing the count rather than its size in bytes, which a huge count would wrap around
+    if (size > in.remaining() / sizeof(T)) {
+        column.clear();
+        in.fail();
+        return;
+    }
+    column.resize(size);
+    in.bytes(column.data(), size * sizeof(T));
+}
+
+}
+
+EntityStore::Id EntityStore::spawn(float x, float y, Direction direction, float speed, std::int16_t health)
+{
+    std::uint32_t slot;
+    if (free_slots_.empty()) {
+        slot = static_cast<std::uint32_t>(dense_index_.size());
+        if (slot > slot_mask) {
+            return invalid_id;
+        }
+        dense_index_.push_back(0);
+        generation_.push_back(0);
+    } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    const Id id = (generation_[slot] << slot_bits) | slot;
+    dense_index_[slot] = static_cast<std::uint32_t>(ids_.size());
+
+    ids_.push_back(id);
+    x_.push_back(x);
+    y_.push_back(y);
+    previous_x_.push_back(x);
+    previous_y_.push_back(y);
+    vx_.push_back(direction_x[direction] * speed);
+    vy_.push_back(direction_y[direction] * speed);
+    direction_.push_back(direction);
+    health_.push_back(health);
+    return id;
+}
+
+void EntityStore::reserve(int count)
+{
+    ids_.reserve(count);
+    x_.reserve(count);
+    y_.reserve(count);
+    previous_x_.reserve(count);
+    previous_y_.reserve(count);
+    vx_.reserve(count);
+    vy_.reserve(count);
+    direction_.reserve(count);
+    health_.reserve(count);
+    dense_index_.reserve(count);
+    generation_.reserve(count);
+    free_slots_.reserve(count);
+}
+
+void EntityStore::despawn(Id id)
+{
+    const int index = index_of(id);
+    if (index < 0) {
+        return;
+    }
+    const std::uint32_t slot = id & slot_mask;
+    dense_index_[ids_.back() & slot_mask] = index;
+    removeAt(ids_, index);
+    removeAt(x_, index);
+    removeAt(y_, index);
+    removeAt(previous_x_, index);
+    removeAt(previous_y_, index);
+    removeAt(vx_, index);
+    removeAt(vy_, index);
+    removeAt(direction_, index);
+    removeAt(health_, index);
+    // wrap the generation so it never spills into the slot bits
+    generation_[slot] = (generation_[slot] + 1) & (invalid_id >> slot_bits);
+    free_slots_.push_back(slot);
+}
+
+bool EntityStore::alive(Id id) const
+{
+    return index_of(id) >= 0;
+}
+
+int EntityStore::index_of(Id id) const
+{
+    const std::uint32_t slot = id & slot_mask;
+    if (id == invalid_id || slot >= dense_index_.size() || generation_[slot] != id >> slot_bits) {
+        return -1;
+    }
+    return static_cast<int>(dense_index_[slot]);
+}
+
+void EntityStore::steer(int index, Direction direction, float speed)
+{
+    direction_[index] = direction;
+    vx_[index] = direction_x[direction] * speed;
+    vy_[index] = direction_y[direction] * speed;
+}
+
+void EntityStore::integrate(float seconds)
+{
+    const int count = size();
+    float *x = x_.data();
+    float *y = y_.data();
+    float *previous_x = previous_x_.data();
+    float *previous_y = previous_y_.data();
+    const float *vx = vx_.data();
+    const float *vy = vy_.data();
+    for (int i=0; i<count; ++i) {
+        previous_x[i] = x[i];
+        previous_y[i] = y[i];
+    }
+    for (int i=0; i<count; ++i) {
+        x[i] += vx[i] * seconds;
+        y[i] += vy[i] * seconds;
+    }
+}
+
+void EntityStore::write(ByteWriter &out) const
+{
+    // the columns are written in host byte order, all supported targets are little endian
+    out.varint(ids_.size());
+    writeColumn(out, ids_);
+    writeColumn(out, x_);
+    writeColumn(out, y_);
+    writeColumn(out, previous_x_);
+    writeColumn(out, previous_y_);
+    writeColumn(out, vx_);
+    writeColumn(out, vy_);
+    writeColumn(out, direction_);
+    writeColumn(out, health_);
+    out.varint(dense_index_.size());
+    writeColumn(out, dense_index_);
+    writeColumn(out, generation_);
+    out.varint(free_slots_.size());
+    writeColumn(out, free_slots_);
+}
+
+bool EntityStore::read(ByteReader &in)
+{
+    const std::size_t count = in.varint();
+    readColumn(in, ids_, count);
+    readColumn(in, x_, count);
+    readColumn(in, y_, count);
+    readColumn(in, previous_x_, count);
+    readColumn(in, previous_y_, count);
+    readColumn(in, vx_, count);
+    readColumn(in, vy_, count);
+    readColumn(in, direction_, count);
+    readColumn(in, health_, count);
+    const std::size_t slot_count = in.varint();
+    readColumn(in, dense_index_, slot_count);
+    readColumn(in, generation_, slot_count);
+    readColumn(in, free_slots_, in.varint());
+    bool valid = in.ok() && dense_index_.size() <= static_cast<std::size_t>(slot_mask) + 1;
+    // the indices and directions are used without checks later, do not trust them blindly
+    for (std::size_t i=0; valid && i<ids_.size(); ++i) {
+        const std::uint32_t slot = ids_[i] & slot_mask;
+        valid = ids_[i] != invalid_id && slot < dense_index_.size() && dense_index_[slot] == i
+                && generation_[slot] == ids_[i] >> slot_bits && direction_[i] <= Left;
+    }
+    // spawn() hands out free slots again, so a slot in use or listed twice would clobber an entity
+    std::vector<bool> seen(valid ? dense_index_.size() : 0, false);
+    for (std::size_t i=0; valid && i<ids_.size(); ++i) {
+        seen[ids_[i] & slot_mask] = true;
+    }
+    for (std::size_t i=0; valid && i<free_slots_.size(); ++i) {
+        const std::uint32_t slot = free_slots_[i];
+        valid = slot < dense_index_.size() && !seen[slot];
+        if (valid) {
+            seen[slot] = true;
+        }
+    }
+    if (!valid) {
+        *this = EntityStore();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include <cstdint>
+#include <vector>
+
+#include "resource_counter.h"
+
+namespace game {
+
+    class ByteReader;
+    class ByteWriter;
+
+    enum Direction : std::uint8_t {
+        Up,
+        Right,
+        Down,
+        Left
+    };
+
+    /**
+     * @brief The EntityStore class keeps one kind of entity in structure-of-arrays form
+     *
+     * Every property lives in its own densely packed column, entity i of the store is at
+     * index i of every column. Update passes are straight loops over plain float arrays that
+     * the compiler can vectorize. Despawning moves the last entity into the freed index, so
+     * the columns never have holes and indices are not stable; use the Id returned by spawn()
+     * to refer to an entity across ticks.
+     *
+     * Positions are the centers of the entities in cell units: the cell at (row, col) covers
+     * [col, col + 1] x [row, row + 1], Up is towards higher rows. Velocities are in cells per
+     * second.
+     */
+    class EntityStore
+    {
+    public:
+        /**
+         * @brief Id is a handle that stays valid until its entity despawns
+         *
+         * The lower slot_bits bits select a slot, the upper bits count how often the slot was
+         * reused, so stale handles of despawned entities are recognized.
+         */
+        typedef std::uint32_t Id;
+        static constexpr Id invalid_id = 0xffffffff;
+
+        /**
+         * @brief memory counts the columns and slot tables of all stores
+         */
+        static ResourceCounter memory;
+
+        Id spawn(float x, float y, Direction direction, float speed, std::int16_t health);
+
+        /**
+         * @brief reserve makes room for count entities, which then spawn and despawn without
+         * allocating
+         */
+        void reserve(int count);
+
+        /**
+         * @brief despawn removes an entity, ids that are not alive are ignored
+         */
+        void despawn(Id id);
+
+        bool alive(Id id) const;
+
+        /**
+         * @brief index_of finds the current dense index of an entity
+         * @return the index, or -1 if the entity is not alive
+         */
+        int index_of(Id id) const;
+
+        /**
+         * @brief steer changes the direction of an entity and sets its velocity accordingly
+         */
+        void steer(int index, Direction direction, float speed);
+
+        /**
+         * @brief integrate remembers the current positions as previous ones and moves every
+         * entity by its velocity
+         */
+        void integrate(float seconds);
+
+        int size() const {
+            return static_cast<int>(ids_.size());
+        }
+
+        /**
+         * @brief write stores the complete state including the slots of despawned entities,
+         * such that a store restored by read() hands out the same ids in the future
+         */
+        void write(ByteWriter &out) const;
+
+        /**
+         * @brief read replaces the state by one stored with write()
+         * @return false if the data is invalid, the store is empty then
+         */
+        bool read(ByteReader &in);
+
+        const Id *ids() const { return ids_.data(); }
+        float *x() { return x_.data(); }
+        const float *x() const { return x_.data(); }
+        float *y() { return y_.data(); }
+        const float *y() const { return y_.data(); }
+        const float *previous_x() const { return previous_x_.data(); }
+        const float *previous_y() const { return previous_y_.data(); }
+        float *vx() { return vx_.data(); }
+        const float *vx() const { return vx_.data(); }
+        float *vy() { return vy_.data(); }
+        const float *vy() const { return vy_.data(); }
+        const Direction *direction() const { return direction_.data(); }
+        std::int16_t *health() { return health_.data(); }
+        const std::int16_t *health() const { return health_.data(); }
+
+    private:
+        static constexpr int slot_bits = 20;
+        static constexpr Id slot_mask = (1u << slot_bits) - 1;
+
+        template <typename T>
+        using Column = std::vector<T, CountingAllocator<T, memory>>;
+
+        // dense columns
+        Column<Id> ids_;
+        Column<float> x_;
+        Column<float> y_;
+        Column<float> previous_x_;
+        Column<float> previous_y_;
+        Column<float> vx_;
+        Column<float> vy_;
+        Column<Direction> direction_;
+        Column<std::int16_t> health_;
+
+        // slot -> dense index and generation of the entity occupying it
+        Column<std::uint32_t> dense_index_;
+        Column<std::uint32_t> generation_;
+        Column<std::uint32_t> free_slots_;
+    };
+
+}
+
+#endif // ENTITIES_H
@@ -0,0 +1,23 @@
+#include "fixed_step.h"
+
+#include <algorithm>
+
+using namespace game;
+
+FixedStep::FixedStep(double step_seconds, double max_frame_seconds)
+    : step_seconds_(step_seconds),
+      max_frame_seconds_(max_frame_seconds),
+      accumulator_(0.0)
+{
+}
+
+int FixedStep::advance(double frame_seconds)
+{
+    accumulator_ += std::min(std::max(frame_seconds, 0.0), max_frame_seconds_);
+    int steps = 0;
+    while (accumulator_ >= step_seconds_) {
+        accumulator_ -= step_seconds_;
+        ++steps;
+    }
+    return steps;
+}
@@ -0,0 +1,46 @@
+#ifndef FIXED_STEP_H
+#define FIXED_STEP_H
+
+namespace game {
+
+    /**
+     * @brief The FixedStep class turns variable frame times into a whole number of fixed
+     * simulation ticks
+     *
+     * Elapsed real time is accumulated and consumed in steps of step_seconds(), the remainder
+     * is exposed as alpha() so that rendering can interpolate between the last two simulated
+     * states. Frame times are clamped to max_frame_seconds, such that a long stall does not
+     * make the simulation fall further and further behind.
+     */
+    class FixedStep
+    {
+    public:
+        FixedStep(double step_seconds, double max_frame_seconds = 0.25);
+
+        /**
+         * @brief advance adds the real time of the last frame to the accumulator
+         * @param frame_seconds the time elapsed since the previous call
+         * @return the number of ticks the simulation has to run to catch up
+         */
+        int advance(double frame_seconds);
+
+        double step_seconds() const {
+            return step_seconds_;
+        }
+
+        /**
+         * @brief alpha is the fraction of a tick that is accumulated but not yet simulated
+         * @return a value in [0, 1) to blend the previous and the current state with
+         */
+        double alpha() const {
+            return accumulator_ / step_seconds_;
+        }
+    private:
+        double step_seconds_;
+        double max_frame_seconds_;
+        double accumulator_;
+    };
+
+}
+
+#endif // FIXED_STEP_H
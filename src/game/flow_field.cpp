@@ -0,0 +1,151 @@
+#include "flow_field.h"
+
+#include <algorithm>
+
+#include "broadphase.h"
+
+using namespace game;
+
+constexpr FlowField::Distance FlowField::unreachable;
+constexpr std::uint8_t FlowField::no_direction;
+
+FlowField::FlowField(const Map &map, int goal_row, int goal_col)
+    : rows_(map.row_count()),
+      cols_(map.col_count()),
+      goal_(goal_row * map.col_count() + goal_col),
+      revision_(map.revision()),
+      passable_(map.cell_count()),
+      distances_(map.cell_count(), unreachable),
+      directions_(map.cell_count(), no_direction)
+{
+    recompute(map);
+}
+
+int FlowField::neighbor(int index, int direction) const
+{
+    const int row = index / cols_;
+    const int col = index % cols_;
+    switch (direction) {
+    case Up:
+        return row + 1 < rows_ ? index + cols_ : -1;
+    case Right:
+        return col + 1 < cols_ ? index + 1 : -1;
+    case Down:
+        return row > 0 ? index - cols_ : -1;
+    default:
+        return col > 0 ? index - 1 : -1;
+    }
+}
+
+void FlowField::recompute(const Map &map)
+{
+    for (int i=0; i<map.cell_count(); ++i) {
+        passable_[i] = !blocks(Collider::Tank, map.data()[i]);
+    }
+    std::fill(distances_.begin(), distances_.end(), unreachable);
+    distances_[goal_] = 0;
+    changed_.assign(1, goal_);
+    propagate(changed_);
+    for (int i=0; i<map.cell_count(); ++i) {
+        refresh_direction(i);
+    }
+    revision_ = map.revision();
+}
+
+void FlowField::propagate(std::vector<int> &changed)
+{
+    // the seeds may start at different distances, so a cell can be lowered more than once
+    queue_.assign(changed.begin(), changed.end());
+    for (std::size_t head=0; head<queue_.size(); ++head) {
+        const int index = queue_[head];
+        const Distance next = distances_[index] + 1;
+        for (int direction=Up; direction<=Left; ++direction) {
+            const int other = neighbor(index, direction);
+            if (other >= 0 && passable_[other] && next < distances_[other]) {
+                distances_[other] = next;
+                queue_.push_back(other);
+                changed.push_back(other);
+            }
+        }
+    }
+}
+
+void FlowField::refresh_direction(int index)
+{
+    directions_[index] = no_direction;
+    const Distance distance = distances_[index];
+    if (distance == 0 || distance == unreachable) {
+        return;
+    }
+    for (int direction=Up; direction<=Left; ++direction) {
+        const int other = neighbor(index, direction);
+        if (other >= 0 && distances_[other] + 1 == distance) {
+            directions_[index] = static_cast<std::uint8_t>(direction);
+            return;
+        }
+    }
+}
+
+int FlowField::update(const Map &map)
+{
+    if (map.revision() == revision_) {
+        return 0;
+    }
+    changed_.clear();
+    for (int chunk_row=0; chunk_row<map.chunk_row_count(); ++chunk_row) {
+        for (int chunk_col=0; chunk_col<map.chunk_col_count(); ++chunk_col) {
+            if (map.chunk_revision(chunk_row, chunk_col) <= revision_) {
+                continue;
+            }
+            const Map::ChunkBounds bounds = map.chunk_bounds(chunk_row, chunk_col);
+            for (int i=bounds.row_begin; i<bounds.row_end; ++i) {
+                for (int j=bounds.col_begin; j<bounds.col_end; ++j) {
+                    const int index = i * cols_ + j;
+                    const std::uint8_t passable = !blocks(Collider::Tank, map.cell(i, j));
+                    if (passable == passable_[index]) {
+                        continue;
+                    }
+                    if (!passable) {
+                        // distances may grow behind a new obstacle, which the search cannot undo
+                        recompute(map);
+                        return map.cell_count();
+                    }
+                    passable_[index] = 1;
+                    changed_.push_back(index);
+                }
+            }
+        }
+    }
+    revision_ = map.revision();
+
+    // an opened cell continues the path of its closest neighbor, blocked cells other than
+    // the goal are unreachable themselves
+    std::size_t seeds = 0;
+    for (int index : changed_) {
+        Distance best = unreachable;
+        for (int direction=Up; direction<=Left; ++direction) {
+            const int other = neighbor(index, direction);
+            if (other >= 0 && distances_[other] != unreachable) {
+                best = std::min(best, distances_[other] + 1);
+            }
+        }
+        if (index != goal_ && best < distances_[index]) {
+            distances_[index] = best;
+            changed_[seeds++] = index;
+        }
+    }
+    changed_.resize(seeds);
+    propagate(changed_);
+
+    // directions depend on the distances of the neighbors, refresh around every change
+    for (int index : changed_) {
+        refresh_direction(index);
+        for (int direction=Up; direction<=Left; ++direction) {
+            const int other = neighbor(index, direction);
+            if (other >= 0) {
+                refresh_direction(other);
+            }
+        }
+    }
+    return static_cast<int>(changed_.size());
+}
@@ -0,0 +1,79 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "entities.h"
+#include "map.h"
+
+namespace game {
+
+    /**
+     * @brief The FlowField class tells every cell of a map which way leads to a goal cell
+     *
+     * A breadth first search over the cells tanks can drive on (see blocks()) computes the
+     * distance of each cell to the goal and the direction towards its neighbor closest to the
+     * goal, ties resolved in the order of Direction. AI tanks then steer with a single lookup
+     * of direction() per tick instead of searching paths of their own.
+     *
+     * update() follows the revisions of the map: cells that opened up, such as destroyed clay,
+     * only lower distances, so the search restarts from those cells and stops where distances
+     * no longer improve. Cells that became blocked are rare and make the field recompute.
+     */
+    class FlowField
+    {
+    public:
+        typedef std::uint32_t Distance;
+        static constexpr Distance unreachable = std::numeric_limits<Distance>::max();
+        // direction() of the goal and of cells without a path
+        static constexpr std::uint8_t no_direction = 4;
+
+        FlowField(const Map &map, int goal_row, int goal_col);
+
+        /**
+         * @brief update brings the field up to date with the map it was built for
+         * @return the number of cells whose distance changed
+         */
+        int update(const Map &map);
+
+        Distance distance(int row, int col) const {
+            return distances_[row * cols_ + col];
+        }
+
+        /**
+         * @brief direction gives the way to go from a cell
+         * @return a Direction, or no_direction at the goal and where the goal cannot be reached
+         */
+        std::uint8_t direction(int row, int col) const {
+            return directions_[row * cols_ + col];
+        }
+
+        int goal_row() const {
+            return goal_ / cols_;
+        }
+        int goal_col() const {
+            return goal_ % cols_;
+        }
+    private:
+        void recompute(const Map &map);
+        void propagate(std::vector<int> &changed);
+        void refresh_direction(int index);
+        int neighbor(int index, int direction) const;
+
+        int rows_;
+        int cols_;
+        int goal_;
+        Map::Revision revision_;
+        std::vector<std::uint8_t> passable_;
+        std::vector<Distance> distances_;
+        std::vector<std::uint8_t> directions_;
+        // scratch space of the searches
+        std::vector<int> queue_;
+        std::vector<int> changed_;
+    };
+
+}
+
+#endif // FLOW_FIELD_H
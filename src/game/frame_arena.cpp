@@ -0,0 +1,55 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+
+using namespace game;
+
+ResourceCounter FrameArena::memory("frame_arena");
+
+void FrameArena::BlockDeleter::operator()(char *block) const
+{
+    memory.release(size);
+    delete[] block;
+}
+
+FrameArena::Block FrameArena::allocate_block(std::size_t size)
+{
+    memory.acquire(size);
+    BlockDeleter deleter = {size};
+    return Block(new char[size], deleter);
+}
+
+FrameArena::FrameArena(std::size_t capacity)
+    : block_(allocate_block(std::max<std::size_t>(capacity, 1))),
+      capacity_(std::max<std::size_t>(capacity, 1)),
+      offset_(0),
+      used_(0)
+{
+}
+
+void *FrameArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    used_ += bytes + alignment - 1;
+    const std::size_t address = reinterpret_cast<std::size_t>(block_.get()) + offset_;
+    const std::size_t padding = (alignment - address % alignment) % alignment;
+    if (offset_ + padding + bytes <= capacity_) {
+        offset_ += padding + bytes;
+        return block_.get() + offset_ - bytes;
+    }
+    // new[] of char is aligned for every fundamental type
+    overflow_.push_back(allocate_block(std::max<std::size_t>(bytes, 1)));
+    return overflow_.back().get();
+}
+
+void FrameArena::reset()
+{
+    if (!overflow_.empty()) {
+        overflow_.clear();
+        while (capacity_ < used_) {
+            capacity_ *= 2;
+        }
+        block_ = allocate_block(capacity_);
+    }
+    offset_ = 0;
+    used_ = 0;
+}
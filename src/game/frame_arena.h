@@ -0,0 +1,122 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "resource_counter.h"
+
+namespace game {
+
+    /**
+     * @brief The FrameArena class hands out memory for data that lives for one frame or tick
+     *
+     * Allocation bumps a pointer through one block and freeing is a no-op, reset() releases
+     * everything at once. When a frame needs more than the block holds, the excess comes from
+     * extra heap blocks, and the next reset() replaces the block by one large enough for the
+     * whole frame, so frames of the same shape stop allocating after the first one.
+     */
+    class FrameArena
+    {
+    public:
+        explicit FrameArena(std::size_t capacity = 64 * 1024);
+
+        FrameArena(const FrameArena &) = delete;
+        FrameArena &operator=(const FrameArena &) = delete;
+        FrameArena(FrameArena &&) = default;
+        FrameArena &operator=(FrameArena &&) = default;
+
+        /**
+         * @brief memory counts the blocks of all arenas, including the extra ones of a frame
+         */
+        static ResourceCounter memory;
+
+        void *allocate(std::size_t bytes, std::size_t alignment);
+
+        /**
+         * @brief reset frees all allocations, memory handed out before must not be used anymore
+         */
+        void reset();
+
+        std::size_t capacity() const {
+            return capacity_;
+        }
+        /**
+         * @brief used tells how many bytes were allocated since the last reset()
+         */
+        std::size_t used() const {
+            return used_;
+        }
+    private:
+        /**
+         * @brief The BlockDeleter struct frees a block and releases its size from memory
+         */
+        struct BlockDeleter {
+            std::size_t size;
+            void operator()(char *block) const;
+        };
+        typedef std::unique_ptr<char[], BlockDeleter> Block;
+
+        static Block allocate_block(std::size_t size);
+
+        Block block_;
+        std::size_t capacity_;
+        std::size_t offset_;
+        std::size_t used_;
+        std::vector<Block> overflow_;
+    };
+
+    /**
+     * @brief The ArenaAllocator class lets standard containers allocate from a FrameArena
+     *
+     * Containers using it must not outlive the next reset() of their arena.
+     */
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit ArenaAllocator(FrameArena &arena)
+            : arena_(&arena)
+        {
+        }
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other)
+            : arena_(other.arena())
+        {
+        }
+
+        T *allocate(std::size_t count) {
+            return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *, std::size_t) {
+        }
+
+        FrameArena *arena() const {
+            return arena_;
+        }
+    private:
+        FrameArena *arena_;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+    {
+        return a.arena() == b.arena();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+    {
+        return a.arena() != b.arena();
+    }
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,65 @@
+#include "input_queue.h"
+
+using namespace game;
+
+InputQueue::InputQueue()
+    : held_(0),
+      pressed_(0),
+      event_count_(0),
+      total_latency_(0),
+      max_latency_(0),
+      dropped_(0)
+{
+}
+
+bool InputQueue::push(std::uint8_t button, bool pressed, Clock::time_point time)
+{
+    InputEvent event;
+    event.time = time;
+    event.button = button;
+    event.pressed = pressed;
+    if (!events_.push(event)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+std::uint8_t InputQueue::consume(Clock::time_point deadline)
+{
+    const InputEvent *event = events_.front();
+    if (event && event->time <= deadline) {
+        const Clock::time_point now = Clock::now();
+        do {
+            if (event->pressed) {
+                held_ |= event->button;
+                pressed_ |= event->button;
+            } else {
+                held_ &= ~event->button;
+            }
+            const long long latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - event->time).count();
+            total_latency_.fetch_add(latency, std::memory_order_relaxed);
+            if (latency > max_latency_.load(std::memory_order_relaxed)) {
+                // only the consumer writes the maximum, a plain store cannot lose an update
+                max_latency_.store(latency, std::memory_order_relaxed);
+            }
+            event_count_.fetch_add(1, std::memory_order_relaxed);
+            events_.pop();
+            event = events_.front();
+        } while (event && event->time <= deadline);
+    }
+    const std::uint8_t buttons = held_ | pressed_;
+    pressed_ = 0;
+    return buttons;
+}
+
+InputLatency InputQueue::latency() const
+{
+    InputLatency latency;
+    latency.events = event_count_.load(std::memory_order_relaxed);
+    latency.dropped = dropped_.load(std::memory_order_relaxed);
+    latency.average_seconds = latency.events > 0
+            ? 1e-9 * total_latency_.load(std::memory_order_relaxed) / latency.events : 0.0;
+    latency.max_seconds = 1e-9 * max_latency_.load(std::memory_order_relaxed);
+    return latency;
+}
@@ -0,0 +1,83 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "spsc_ring.h"
+
+namespace game {
+
+    /**
+     * @brief The InputEvent struct is one press or release of a game::Buttons button
+     */
+    struct InputEvent {
+        std::chrono::steady_clock::time_point time;
+        std::uint8_t button;
+        bool pressed;
+    };
+
+    /**
+     * @brief The InputLatency struct summarizes how long events waited for the tick that
+     * consumed them
+     */
+    struct InputLatency {
+        long events;
+        long dropped;
+        double average_seconds;
+        double max_seconds;
+    };
+
+    /**
+     * @brief The InputQueue class carries the button events of a local player from the thread
+     * that polls the window to the thread that runs the simulation
+     *
+     * Window callbacks push() timestamped events into an SpscRing, the simulation calls
+     * consume() once per tick and controls the player with the result. A tick applies all
+     * events up to its deadline in order, a button that was pressed and released again since
+     * the previous tick still counts as held for that tick, so short taps are not lost.
+     *
+     * latency() may be called from any thread.
+     */
+    class InputQueue
+    {
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        InputQueue();
+
+        InputQueue(const InputQueue &) = delete;
+        InputQueue &operator=(const InputQueue &) = delete;
+
+        /**
+         * @brief push queues an event, producer thread only
+         * @return false if the queue is full and the event was dropped
+         */
+        bool push(std::uint8_t button, bool pressed, Clock::time_point time = Clock::now());
+
+        /**
+         * @brief consume applies the events that happened up to deadline, consumer thread only
+         * @return the buttons the player holds during the next tick
+         */
+        std::uint8_t consume(Clock::time_point deadline);
+
+        InputLatency latency() const;
+
+    private:
+        SpscRing<InputEvent, 256> events_;
+        // consumer state
+        std::uint8_t held_;
+        std::uint8_t pressed_;
+
+        // written by the consumer
+        std::atomic<long> event_count_;
+        std::atomic<long long> total_latency_;
+        std::atomic<long long> max_latency_;
+        // written by the producer, kept off the cache line of the consumer counters
+        alignas(64) std::atomic<long> dropped_;
+    };
+
+}
+
+#endif // INPUT_QUEUE_H
@@ -0,0 +1,137 @@
+#include "level_file.h"
+
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LEVEL_FILE_MMAP
+#else
+#include <fstream>
+#endif
+
+using namespace game;
+
+namespace {
+
+std::uint16_t readLittleEndian16(const std::uint8_t *bytes)
+{
+    return static_cast<std::uint16_t>(bytes[0] | bytes[1] << 8);
+}
+
+std::uint32_t readLittleEndian32(const std::uint8_t *bytes)
+{
+    return static_cast<std::uint32_t>(bytes[0]) | static_cast<std::uint32_t>(bytes[1]) << 8
+            | static_cast<std::uint32_t>(bytes[2]) << 16 | static_cast<std::uint32_t>(bytes[3]) << 24;
+}
+
+void writeLittleEndian16(std::uint16_t value, std::uint8_t *bytes)
+{
+    bytes[0] = value & 0xff;
+    bytes[1] = value >> 8;
+}
+
+void writeLittleEndian32(std::uint32_t value, std::uint8_t *bytes)
+{
+    for (int i=0; i<4; ++i) {
+        bytes[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+}
+
+bool game::readLevelHeader(const std::uint8_t *bytes, std::size_t size, LevelHeader &header)
+{
+    if (size < level_header_size || std::memcmp(bytes, level_magic, sizeof(level_magic)) != 0) {
+        return false;
+    }
+    std::memcpy(header.magic, bytes, sizeof(header.magic));
+    header.version = readLittleEndian16(bytes + 4);
+    header.header_size = readLittleEndian16(bytes + 6);
+    header.rows = readLittleEndian32(bytes + 8);
+    header.cols = readLittleEndian32(bytes + 12);
+    if (header.version != level_version || header.header_size < level_header_size) {
+        return false;
+    }
+    // the cell count must fit into an int and all cells must be present in the file
+    const std::uint64_t cells = static_cast<std::uint64_t>(header.rows) * header.cols;
+    return header.rows <= 0x7fffffff && header.cols <= 0x7fffffff && cells <= 0x7fffffff
+            && header.header_size + cells <= size;
+}
+
+void game::writeLevelHeader(int rows, int cols, std::uint8_t *bytes)
+{
+    std::memcpy(bytes, level_magic, sizeof(level_magic));
+    writeLittleEndian16(level_version, bytes + 4);
+    writeLittleEndian16(level_header_size, bytes + 6);
+    writeLittleEndian32(rows, bytes + 8);
+    writeLittleEndian32(cols, bytes + 12);
+}
+
+ResourceCounter MappedFile::memory("map_files");
+
+MappedFile::MappedFile(std::uint8_t *data, std::size_t size)
+    : data_(data),
+      size_(size)
+{
+    memory.acquire(size_);
+}
+
+#ifdef LEVEL_FILE_MMAP
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    void *data = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+    return std::shared_ptr<MappedFile>(new MappedFile(static_cast<std::uint8_t*>(data), info.st_size));
+}
+
+MappedFile::~MappedFile()
+{
+    memory.release(size_);
+    munmap(data_, size_);
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return nullptr;
+    }
+    const std::size_t size = static_cast<std::size_t>(file.tellg());
+    if (size == 0) {
+        return nullptr;
+    }
+    std::uint8_t *data = new std::uint8_t[size];
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data), size)) {
+        delete[] data;
+        return nullptr;
+    }
+    return std::shared_ptr<MappedFile>(new MappedFile(data, size));
+}
+
+MappedFile::~MappedFile()
+{
+    memory.release(size_);
+    delete[] data_;
+}
+
+#endif
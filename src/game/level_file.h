@@ -0,0 +1,85 @@
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "resource_counter.h"
+
+namespace game {
+
+    /**
+     * @brief The LevelHeader struct starts every binary level file
+     *
+     * All fields are stored little endian. The header is followed by rows * cols cell bytes
+     * in row-major order, the same layout as Map::data(), starting at header_size bytes
+     * into the file, so a level can be used straight from a memory mapping.
+     */
+    struct LevelHeader {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t header_size;
+        std::uint32_t rows;
+        std::uint32_t cols;
+    };
+
+    const char level_magic[4] = {'B', 'C', 'L', 'V'};
+    const std::uint16_t level_version = 1;
+    const std::size_t level_header_size = 16;
+
+    /**
+     * @brief readLevelHeader decodes and validates the header at the start of a level file
+     * @param size the size of the whole file, used to check that all cells are present
+     * @return false if the bytes are not a level of a supported version
+     */
+    bool readLevelHeader(const std::uint8_t *bytes, std::size_t size, LevelHeader &header);
+
+    /**
+     * @brief writeLevelHeader encodes a header for the current version into level_header_size bytes
+     */
+    void writeLevelHeader(int rows, int cols, std::uint8_t *bytes);
+
+    /**
+     * @brief The MappedFile class maps a whole file into memory for as long as it exists
+     *
+     * The mapping is private and copy-on-write: pages are shared with the page cache, and
+     * with every other process that maps the same file, until they are written to. Writes
+     * never reach the file. On platforms without mmap the file is read into memory instead.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief open maps the file at path
+         * @return the mapping, or nullptr if the file cannot be opened or mapped
+         */
+        static std::shared_ptr<MappedFile> open(const std::string &path);
+
+        ~MappedFile();
+
+        /**
+         * @brief memory counts the open level files and their sizes
+         */
+        static ResourceCounter memory;
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        std::uint8_t *data() {
+            return data_;
+        }
+        std::size_t size() const {
+            return size_;
+        }
+    private:
+        MappedFile(std::uint8_t *data, std::size_t size);
+
+        std::uint8_t *data_;
+        std::size_t size_;
+    };
+
+}
+
+#endif // LEVEL_FILE_H
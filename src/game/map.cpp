@@ -1,12 +1,241 @@
 #include "map.h"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "cell_kernels.h"
+#include "level_file.h"
+
 using namespace game;
 
-Map::Map(int size): data_(size)
+constexpr int Map::chunk_size;
+ResourceCounter Map::memory("map");
+
+Map::Map(int size)
+    : Map(size, size)
+{
+}
+
+Map::Map(int rows, int cols)
+    : rows_(rows),
+      cols_(cols),
+      data_(rows * cols, CellType::Floor),
+      cells_(data_.data()),
+      revision_(0),
+      chunk_revisions_(chunk_row_count() * chunk_col_count(), 0)
+{
+}
+
+Map::Map(int rows, int cols, std::shared_ptr<MappedFile> mapping, CellType *cells)
+    : rows_(rows),
+      cols_(cols),
+      mapping_(std::move(mapping)),
+      cells_(cells),
+      revision_(0),
+      chunk_revisions_(chunk_row_count() * chunk_col_count(), 0)
+{
+}
+
+Map::Map(const Map &other)
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      data_(other.cells_, other.cells_ + other.cell_count()),
+      cells_(data_.data()),
+      revision_(other.revision_),
+      chunk_revisions_(other.chunk_revisions_)
+{
+}
+
+Map::Map(Map &&other)
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      data_(std::move(other.data_)),
+      mapping_(std::move(other.mapping_)),
+      cells_(other.cells_),
+      revision_(other.revision_),
+      chunk_revisions_(std::move(other.chunk_revisions_))
+{
+    other.rows_ = 0;
+    other.cols_ = 0;
+    other.cells_ = nullptr;
+}
+
+Map &Map::operator=(Map other)
+{
+    swap(other);
+    return *this;
+}
+
+void Map::swap(Map &other)
+{
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    data_.swap(other.data_);
+    mapping_.swap(other.mapping_);
+    std::swap(cells_, other.cells_);
+    std::swap(revision_, other.revision_);
+    chunk_revisions_.swap(other.chunk_revisions_);
+}
+
+std::unique_ptr<Map> Map::load(const std::string &path)
+{
+    std::shared_ptr<MappedFile> mapping = MappedFile::open(path);
+    if (!mapping) {
+        return nullptr;
+    }
+    LevelHeader header;
+    if (!readLevelHeader(mapping->data(), mapping->size(), header)) {
+        return nullptr;
+    }
+    static_assert(sizeof(CellType) == 1, "level files store one byte per cell");
+    CellType *cells = reinterpret_cast<CellType*>(mapping->data() + header.header_size);
+    return std::unique_ptr<Map>(new Map(header.rows, header.cols, std::move(mapping), cells));
+}
+
+bool Map::save(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    std::uint8_t header[level_header_size];
+    writeLevelHeader(rows_, cols_, header);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(cells_), cell_count());
+    return static_cast<bool>(file);
+}
+
+void Map::set_cell(int row, int col, CellType type)
 {
-    data_.resize(size);
-    for (auto it=data_.begin(); it != data_.end(); it++) {
-        (*it).resize(size);
+    CellType &cell = cells_[row * cols_ + col];
+    if (cell == type) {
+        return;
     }
+    cell = type;
+    ++revision_;
+    chunk_revisions_[(row / chunk_size) * chunk_col_count() + col / chunk_size] = revision_;
 }
 
+Map::ChunkBounds Map::chunk_bounds(int chunk_row, int chunk_col) const
+{
+    ChunkBounds bounds;
+    bounds.row_begin = chunk_row * chunk_size;
+    bounds.col_begin = chunk_col * chunk_size;
+    bounds.row_end = std::min(bounds.row_begin + chunk_size, rows_);
+    bounds.col_end = std::min(bounds.col_begin + chunk_size, cols_);
+    return bounds;
+}
+
+Map::Rect Map::clip(const Rect &rect) const
+{
+    Rect clipped;
+    clipped.row_begin = std::max(rect.row_begin, 0);
+    clipped.col_begin = std::max(rect.col_begin, 0);
+    clipped.row_end = std::max(std::min(rect.row_end, rows_), clipped.row_begin);
+    clipped.col_end = std::max(std::min(rect.col_end, cols_), clipped.col_begin);
+    return clipped;
+}
+
+template <typename Operation>
+int Map::modify(const Rect &rect, Operation operation)
+{
+    const Rect clipped = clip(rect);
+    if (clipped.row_begin == clipped.row_end || clipped.col_begin == clipped.col_end) {
+        return 0;
+    }
+    std::uint8_t *cells = reinterpret_cast<std::uint8_t*>(cells_);
+    const Revision next = revision_ + 1;
+    int changes = 0;
+    for (int chunk_row=clipped.row_begin / chunk_size; chunk_row<=(clipped.row_end - 1) / chunk_size; ++chunk_row) {
+        for (int chunk_col=clipped.col_begin / chunk_size; chunk_col<=(clipped.col_end - 1) / chunk_size; ++chunk_col) {
+            const ChunkBounds chunk = chunk_bounds(chunk_row, chunk_col);
+            const int row_end = std::min(chunk.row_end, clipped.row_end);
+            const int col_begin = std::max(chunk.col_begin, clipped.col_begin);
+            const int col_end = std::min(chunk.col_end, clipped.col_end);
+            int chunk_changes = 0;
+            for (int i=std::max(chunk.row_begin, clipped.row_begin); i<row_end; ++i) {
+                chunk_changes += static_cast<int>(operation(cells + i * cols_ + col_begin, col_end - col_begin));
+            }
+            if (chunk_changes > 0) {
+                chunk_revisions_[chunk_row * chunk_col_count() + chunk_col] = next;
+                changes += chunk_changes;
+            }
+        }
+    }
+    if (changes > 0) {
+        revision_ = next;
+    }
+    return changes;
+}
+
+void Map::fill(const Rect &rect, CellType type)
+{
+    modify(rect, [type](std::uint8_t *cells, std::size_t count) {
+        const std::size_t changes = count - countCells(cells, count, type);
+        if (changes > 0) {
+            std::memset(cells, type, count);
+        }
+        return changes;
+    });
+}
+
+int Map::replace(const Rect &rect, CellType from, CellType to)
+{
+    if (from == to) {
+        return 0;
+    }
+    return modify(rect, [from, to](std::uint8_t *cells, std::size_t count) {
+        return replaceCells(cells, count, from, to);
+    });
+}
+
+int Map::count(const Rect &rect, CellType type) const
+{
+    const Rect clipped = clip(rect);
+    const std::uint8_t *cells = reinterpret_cast<const std::uint8_t*>(cells_);
+    if (clipped.col_begin == 0 && clipped.col_end == cols_) {
+        // full rows are one contiguous span
+        return static_cast<int>(countCells(cells + clipped.row_begin * cols_,
+                                           (clipped.row_end - clipped.row_begin) * cols_, type));
+    }
+    std::size_t result = 0;
+    for (int i=clipped.row_begin; i<clipped.row_end; ++i) {
+        result += countCells(cells + i * cols_ + clipped.col_begin, clipped.col_end - clipped.col_begin, type);
+    }
+    return static_cast<int>(result);
+}
+
+int Map::diff(const Map &other, std::vector<std::uint64_t> &bits) const
+{
+    if (other.rows_ != rows_ || other.cols_ != cols_) {
+        return -1;
+    }
+    bits.resize((cell_count() + 63) / 64);
+    if (bits.empty()) {
+        return 0;
+    }
+    return static_cast<int>(diffCells(reinterpret_cast<const std::uint8_t*>(cells_),
+                                      reinterpret_cast<const std::uint8_t*>(other.cells_),
+                                      cell_count(), bits.data()));
+}
+
+void Map::update_from(const Map &source)
+{
+    for (int chunk_row=0; chunk_row<chunk_row_count(); ++chunk_row) {
+        for (int chunk_col=0; chunk_col<chunk_col_count(); ++chunk_col) {
+            const Revision chunk_revision = source.chunk_revision(chunk_row, chunk_col);
+            if (chunk_revision <= revision_) {
+                continue;
+            }
+            const ChunkBounds bounds = chunk_bounds(chunk_row, chunk_col);
+            for (int i=bounds.row_begin; i<bounds.row_end; ++i) {
+                std::copy(source.cells_ + i * cols_ + bounds.col_begin, source.cells_ + i * cols_ + bounds.col_end,
+                          cells_ + i * cols_ + bounds.col_begin);
+            }
+            chunk_revisions_[chunk_row * chunk_col_count() + chunk_col] = chunk_revision;
+        }
+    }
+    revision_ = source.revision_;
+}
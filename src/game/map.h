@@ -1,38 +1,219 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "resource_counter.h"
+
 namespace game {
 
+    class MappedFile;
+
+    /**
+     * @brief The Map class stores the cells of a level in a single row-major buffer
+     *
+     * Cells are one byte each and row r starts at data() + r * col_count(), so scans
+     * over the map and uploads to the GPU are linear walks over contiguous memory.
+     *
+     * Maps loaded from a binary level file (see level_file.h) use the memory mapped file as
+     * their cell buffer, without parsing or copying individual cells.
+     *
+     * Modifications are tracked per chunk of chunk_size x chunk_size cells: every chunk
+     * remembers the revision of its last change, so observers can find out which parts
+     * of the map changed since the revision they last synchronized with.
+     */
     class Map
     {
     public:
-        enum CellType {
+        typedef std::uint64_t Revision;
+
+        static constexpr int chunk_size = 32;
+
+        /**
+         * @brief memory counts the cells and chunk revisions of all maps, mapped level files
+         * are counted by MappedFile::memory instead
+         */
+        static ResourceCounter memory;
+
+        /**
+         * @brief The Rect struct is a half-open rectangle of cells
+         */
+        struct Rect {
+            int row_begin;
+            int col_begin;
+            int row_end;
+            int col_end;
+        };
+
+        /**
+         * @brief ChunkBounds is the rectangle covered by a chunk
+         *
+         * Chunks at the right and bottom border are smaller if the map size is not a
+         * multiple of chunk_size.
+         */
+        typedef Rect ChunkBounds;
+
+        enum CellType : std::uint8_t {
             Floor,
             Clay,
             Wall,
             Rock,
             Water,
-            Custom = 1000
+            Custom = 128
         };
 
         Map(int size);
+        Map(int rows, int cols);
+
+        Map(const Map &other);
+        Map(Map &&other);
+        Map &operator=(Map other);
+
+        /**
+         * @brief load memory-maps a binary level file
+         * @return the level, or nullptr if the file cannot be mapped or is not a valid level
+         */
+        static std::unique_ptr<Map> load(const std::string &path);
+
+        /**
+         * @brief save writes the map as a binary level file that load() can map
+         * @return false if the file could not be written
+         */
+        bool save(const std::string &path) const;
+
+        CellType cell(int row, int col) const {
+            return cells_[row * cols_ + col];
+        }
+
+        /**
+         * @brief set_cell changes the type of a cell and marks its chunk as modified
+         *
+         * Setting a cell to the type it already has is not a modification and leaves the
+         * revision untouched.
+         */
+        void set_cell(int row, int col, CellType type);
+
+        /**
+         * @brief bounds is the rectangle covering the whole map
+         */
+        Rect bounds() const {
+            Rect rect = {0, 0, rows_, cols_};
+            return rect;
+        }
+
+        /**
+         * The bulk operations below work on a rectangle of cells, which is clipped to the map.
+         * They run the SIMD kernels of cell_kernels.h over the rows of the rectangle, and the
+         * modifying ones mark only the chunks in which a cell actually changed, all with the
+         * same new revision.
+         */
+
+        /**
+         * @brief fill sets every cell of a rectangle to type
+         */
+        void fill(const Rect &rect, CellType type);
 
-        CellType cell(int row, int col) {
-            return data_[row][col];
+        /**
+         * @brief replace changes the cells of type from in a rectangle into to
+         * @return the number of replaced cells
+         */
+        int replace(const Rect &rect, CellType from, CellType to);
+
+        /**
+         * @brief count counts the cells of a type in a rectangle
+         */
+        int count(const Rect &rect, CellType type) const;
+
+        /**
+         * @brief diff compares all cells with another map of the same size
+         *
+         * Bit i % 64 of bits[i / 64] tells whether the cells at row-major index i differ.
+         * @return the number of differing cells, or -1 if the maps differ in size
+         */
+        int diff(const Map &other, std::vector<std::uint64_t> &bits) const;
+
+        /**
+         * @brief data gives access to the raw row-major cell buffer
+         * @return a pointer to row_count() * col_count() cells
+         */
+        const CellType *data() const {
+            return cells_;
         }
 
         int row_count() const {
-            return data_.size();
+            return rows_;
         }
         int col_count() const {
-            return data_[0].size();
+            return cols_;
+        }
+        int cell_count() const {
+            return rows_ * cols_;
+        }
+
+        /**
+         * @brief revision is a counter that every modification of the cells advances
+         *
+         * Observers such as renderers remember the revision they last synchronized with and
+         * compare it to this value instead of copying the map.
+         * @return the current revision of the map
+         */
+        Revision revision() const {
+            return revision_;
+        }
+
+        int chunk_row_count() const {
+            return (rows_ + chunk_size - 1) / chunk_size;
+        }
+        int chunk_col_count() const {
+            return (cols_ + chunk_size - 1) / chunk_size;
         }
+
+        /**
+         * @brief chunk_revision tells when the cells of a chunk were last modified
+         * @return the map revision of the last change in the chunk, 0 if it was never modified
+         */
+        Revision chunk_revision(int chunk_row, int chunk_col) const {
+            return chunk_revisions_[chunk_row * chunk_col_count() + chunk_col];
+        }
+
+        ChunkBounds chunk_bounds(int chunk_row, int chunk_col) const;
+
+        /**
+         * @brief update_from copies the chunks that changed in source since this map's revision
+         *
+         * This map must be a copy of source taken at an earlier revision, or a map updated from
+         * it before, such that the chunk revisions of both maps describe the same history.
+         * Afterwards this map equals source while only the modified chunks were copied.
+         */
+        void update_from(const Map &source);
     private:
-        typedef std::vector<CellType> MapRowType;
-        typedef std::vector<MapRowType> MapDataType;
+        typedef std::vector<CellType, CountingAllocator<CellType, memory>> MapDataType;
+
+        Map(int rows, int cols, std::shared_ptr<MappedFile> mapping, CellType *cells);
+
+        void swap(Map &other);
+
+        Rect clip(const Rect &rect) const;
+
+        /**
+         * @brief modify runs operation(cells, count) on the row pieces of a rectangle, chunk by
+         * chunk, and marks the chunks for which it reported changed cells
+         * @return the total of the changes operation reported
+         */
+        template <typename Operation>
+        int modify(const Rect &rect, Operation operation);
+
+        int rows_;
+        int cols_;
+        // owns the cells unless the map uses a memory mapped level file
         MapDataType data_;
+        std::shared_ptr<MappedFile> mapping_;
+        CellType *cells_;
+        Revision revision_;
+        std::vector<Revision, CountingAllocator<Revision, memory>> chunk_revisions_;
     };
 
 }
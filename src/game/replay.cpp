@@ -0,0 +1,249 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "byte_stream.h"
+
+using namespace game;
+
+namespace {
+    const char replay_magic[4] = {'B', 'C', 'R', 'P'};
+    const std::uint16_t replay_version = 1;
+    // the side length and cell count a map read from a replay may have
+    const std::uint64_t max_map_side = 1 << 16;
+    const std::uint64_t max_map_cells = 0x7fffffff;
+
+    const std::uint64_t fnv_offset = 14695981039346656037ull;
+    const std::uint64_t fnv_prime = 1099511628211ull;
+
+    std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t hash) {
+        const std::uint8_t *bytes = static_cast<const std::uint8_t*>(data);
+        for (std::size_t i=0; i<size; ++i) {
+            hash = (hash ^ bytes[i]) * fnv_prime;
+        }
+        return hash;
+    }
+
+    // the cells in row-major order as runs of equal cells
+    void writeCells(const Map &map, ByteWriter &out) {
+        out.varint(map.row_count());
+        out.varint(map.col_count());
+        const Map::CellType *cells = map.data();
+        int run = 0;
+        for (int i=0; i<map.cell_count(); ++i) {
+            if (run > 0 && cells[i] != cells[i - 1]) {
+                out.varint(run);
+                out.u8(cells[i - 1]);
+                run = 0;
+            }
+            ++run;
+        }
+        if (run > 0) {
+            out.varint(run);
+            out.u8(cells[map.cell_count() - 1]);
+        }
+    }
+
+    std::unique_ptr<Map> readCells(ByteReader &in) {
+        const std::uint64_t rows = in.varint();
+        const std::uint64_t cols = in.varint();
+        if (!in.ok() || rows > max_map_side || cols > max_map_side || rows * cols > max_map_cells) {
+            return nullptr;
+        }
+        // the runs must cover every cell with the bytes that are left before the map is allocated
+        // (each run takes at least two bytes, so this scan is bounded by in.remaining())
+        ByteReader runs = in;
+        for (std::uint64_t cell=0; cell < rows * cols; ) {
+            const std::uint64_t run = runs.varint();
+            runs.u8();
+            if (!runs.ok() || run == 0 || run > rows * cols - cell) {
+                return nullptr;
+            }
+            cell += run;
+        }
+        std::unique_ptr<Map> map(new Map(static_cast<int>(rows), static_cast<int>(cols)));
+        const int width = map->col_count();
+        int cell = 0;
+        while (cell < map->cell_count()) {
+            const std::uint64_t run = in.varint();
+            const Map::CellType value = static_cast<Map::CellType>(in.u8());
+            if (!in.ok() || run == 0 || run > static_cast<std::uint64_t>(map->cell_count() - cell)) {
+                return nullptr;
+            }
+            for (int end=cell + static_cast<int>(run); cell<end; ) {
+                const int row = cell / width;
+                const int col = cell % width;
+                const int length = std::min(width - col, end - cell);
+                Map::Rect piece = {row, col, row + 1, col + length};
+                map->fill(piece, value);
+                cell += length;
+            }
+        }
+        return map;
+    }
+}
+
+std::uint64_t game::stateHash(const World &world)
+{
+    std::vector<std::uint8_t> state;
+    ByteWriter out(state);
+    world.write_state(out);
+    const int size[2] = {world.map().row_count(), world.map().col_count()};
+    std::uint64_t hash = hashBytes(size, sizeof(size), fnv_offset);
+    hash = hashBytes(state.data(), state.size(), hash);
+    return hashBytes(world.map().data(), world.map().cell_count(), hash);
+}
+
+ReplayRecorder::ReplayRecorder(const World &world)
+    : tick_count_(0)
+{
+    ByteWriter out(start_);
+    writeCells(world.map(), out);
+    std::vector<std::uint8_t> state;
+    ByteWriter state_out(state);
+    world.write_state(state_out);
+    out.varint(state.size());
+    out.bytes(state.data(), state.size());
+}
+
+void ReplayRecorder::record(const World &world)
+{
+    ++tick_count_;
+    if (!runs_.empty() && static_cast<int>(runs_.back().buttons.size()) == world.player_count()) {
+        bool same = true;
+        for (int player=0; player<world.player_count() && same; ++player) {
+            same = runs_.back().buttons[player] == world.buttons(player);
+        }
+        if (same) {
+            ++runs_.back().length;
+            return;
+        }
+    }
+    ReplayRun run;
+    run.length = 1;
+    for (int player=0; player<world.player_count(); ++player) {
+        run.buttons.push_back(world.buttons(player));
+    }
+    runs_.push_back(std::move(run));
+}
+
+bool ReplayRecorder::save(const std::string &path, const World &world) const
+{
+    std::vector<std::uint8_t> bytes(replay_magic, replay_magic + sizeof(replay_magic));
+    ByteWriter out(bytes);
+    out.u16(replay_version);
+    out.bytes(start_.data(), start_.size());
+    out.varint(runs_.size());
+    for (const ReplayRun &run : runs_) {
+        out.varint(run.length);
+        out.varint(run.buttons.size());
+        out.bytes(run.buttons.data(), run.buttons.size());
+    }
+    out.u64(stateHash(world));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return static_cast<bool>(file);
+}
+
+Replay::Replay(Map map)
+    : map_(std::move(map)),
+      tick_count_(0),
+      final_hash_(0),
+      run_(0),
+      run_position_(0),
+      position_(0)
+{
+}
+
+std::unique_ptr<Replay> Replay::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+    const std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    ByteReader in(bytes.data(), bytes.size());
+    char magic[sizeof(replay_magic)];
+    if (!in.bytes(magic, sizeof(magic)) || std::memcmp(magic, replay_magic, sizeof(magic)) != 0
+            || in.u16() != replay_version) {
+        return nullptr;
+    }
+    std::unique_ptr<Map> map = readCells(in);
+    if (!map) {
+        return nullptr;
+    }
+    std::unique_ptr<Replay> replay(new Replay(std::move(*map)));
+    const std::uint64_t state_size = in.varint();
+    if (state_size > in.remaining()) {
+        return nullptr;
+    }
+    replay->state_.resize(state_size);
+    in.bytes(replay->state_.data(), state_size);
+
+    const std::uint64_t run_count = in.varint();
+    if (run_count > in.remaining()) {
+        return nullptr;
+    }
+    replay->runs_.resize(run_count);
+    for (ReplayRun &run : replay->runs_) {
+        run.length = in.varint();
+        const std::uint64_t players = in.varint();
+        if (players > in.remaining()) {
+            return nullptr;
+        }
+        run.buttons.resize(players);
+        in.bytes(run.buttons.data(), players);
+        replay->tick_count_ += run.length;
+    }
+    replay->final_hash_ = in.u64();
+    if (!in.ok()) {
+        return nullptr;
+    }
+    // the initial state has to be readable as well
+    World probe(replay->map_);
+    ByteReader state(replay->state_.data(), replay->state_.size());
+    if (!probe.read_state(state)) {
+        return nullptr;
+    }
+    return replay;
+}
+
+World Replay::start()
+{
+    run_ = 0;
+    run_position_ = 0;
+    position_ = 0;
+    World world(map_);
+    ByteReader in(state_.data(), state_.size());
+    world.read_state(in);
+    return world;
+}
+
+bool Replay::step(World &world)
+{
+    while (run_ < runs_.size() && run_position_ == runs_[run_].length) {
+        ++run_;
+        run_position_ = 0;
+    }
+    if (run_ == runs_.size()) {
+        return false;
+    }
+    const std::vector<std::uint8_t> &buttons = runs_[run_].buttons;
+    while (world.player_count() < static_cast<int>(buttons.size())) {
+        world.add_player();
+    }
+    for (std::size_t player=0; player<buttons.size(); ++player) {
+        world.control(static_cast<int>(player), buttons[player]);
+    }
+    world.update();
+    ++run_position_;
+    ++position_;
+    return true;
+}
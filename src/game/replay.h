@@ -0,0 +1,125 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "map.h"
+#include "world.h"
+
+namespace game {
+
+    /**
+     * @brief stateHash condenses the complete state of a world including its map
+     *
+     * Two worlds with the same hash are, for all practical purposes, in the same state,
+     * which is how replays check that the simulation is still deterministic.
+     */
+    std::uint64_t stateHash(const World &world);
+
+    /**
+     * @brief The ReplayRun struct is a number of consecutive ticks with the same buttons
+     *
+     * buttons holds one entry per player, players joining show up as a longer list.
+     */
+    struct ReplayRun {
+        std::uint64_t length;
+        std::vector<std::uint8_t> buttons;
+    };
+
+    /**
+     * @brief The ReplayRecorder class records a match from a starting state, tick by tick
+     *
+     * A replay file holds the map and the entity state the recording started from, the
+     * buttons of every player for every tick and the stateHash() of the final state.
+     * Consecutive ticks with the same buttons are stored once with a count, so a match in
+     * which the players hold their buttons for a few ticks at a time costs a few hundred
+     * bytes per minute whatever the size of the map.
+     */
+    class ReplayRecorder
+    {
+    public:
+        /**
+         * @brief ReplayRecorder starts recording from the current state of world
+         */
+        explicit ReplayRecorder(const World &world);
+
+        /**
+         * @brief record stores the players and their buttons of the tick world just simulated
+         */
+        void record(const World &world);
+
+        std::uint64_t tick_count() const {
+            return tick_count_;
+        }
+
+        /**
+         * @brief save writes the replay, with the hash of world as the expected final state
+         * @return false if the file could not be written
+         */
+        bool save(const std::string &path, const World &world) const;
+
+    private:
+        std::vector<std::uint8_t> start_;
+        std::vector<ReplayRun> runs_;
+        std::uint64_t tick_count_;
+    };
+
+    /**
+     * @brief The Replay class plays back what a ReplayRecorder saved
+     *
+     * Playback does not depend on wall clock time, the caller decides whether to step()
+     * once per World::tick_seconds or as fast as the simulation allows.
+     */
+    class Replay
+    {
+    public:
+        /**
+         * @brief load reads a replay file
+         * @return the replay, nullptr if the file is missing or invalid
+         */
+        static std::unique_ptr<Replay> load(const std::string &path);
+
+        /**
+         * @brief start creates a world in the recorded starting state and rewinds the replay
+         */
+        World start();
+
+        /**
+         * @brief step simulates the next recorded tick on world
+         * @return false once all ticks were played
+         */
+        bool step(World &world);
+
+        std::uint64_t tick_count() const {
+            return tick_count_;
+        }
+        std::uint64_t position() const {
+            return position_;
+        }
+        /**
+         * @brief final_hash is the stateHash() of the world the recording ended with
+         */
+        std::uint64_t final_hash() const {
+            return final_hash_;
+        }
+
+    private:
+        explicit Replay(Map map);
+
+        Map map_;
+        std::vector<std::uint8_t> state_;
+        std::vector<ReplayRun> runs_;
+        std::uint64_t tick_count_;
+        std::uint64_t final_hash_;
+
+        std::size_t run_;
+        std::uint64_t run_position_;
+        std::uint64_t position_;
+    };
+
+}
+
+#endif // REPLAY_H
@@ -0,0 +1,92 @@
+#include "resource_counter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace game;
+
+namespace {
+
+// zero initialized before any counter is constructed
+const ResourceCounter *first_counter = nullptr;
+
+std::vector<const ResourceCounter*> sortedCounters()
+{
+    std::vector<const ResourceCounter*> counters;
+    for (const ResourceCounter *counter = ResourceCounter::first(); counter; counter = counter->next()) {
+        counters.push_back(counter);
+    }
+    std::sort(counters.begin(), counters.end(), [](const ResourceCounter *a, const ResourceCounter *b) {
+        return std::strcmp(a->name(), b->name()) < 0;
+    });
+    return counters;
+}
+
+}
+
+ResourceCounter::ResourceCounter(const char *name)
+    : name_(name),
+      objects_(0),
+      created_(0),
+      bytes_(0),
+      peak_bytes_(0),
+      next_(first_counter)
+{
+    first_counter = this;
+}
+
+void ResourceCounter::acquire(std::size_t bytes, long objects)
+{
+    objects_.fetch_add(objects, std::memory_order_relaxed);
+    created_.fetch_add(objects, std::memory_order_relaxed);
+    const long long total = bytes_.fetch_add(static_cast<long long>(bytes), std::memory_order_relaxed)
+            + static_cast<long long>(bytes);
+    long long peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (total > peak && !peak_bytes_.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+    }
+}
+
+void ResourceCounter::release(std::size_t bytes, long objects)
+{
+    objects_.fetch_sub(objects, std::memory_order_relaxed);
+    bytes_.fetch_sub(static_cast<long long>(bytes), std::memory_order_relaxed);
+}
+
+const ResourceCounter *ResourceCounter::first()
+{
+    return first_counter;
+}
+
+void game::printResourceCounters(std::ostream &out)
+{
+    out << std::left << std::setw(24) << "resource" << std::right
+        << std::setw(10) << "objects" << std::setw(10) << "created"
+        << std::setw(14) << "KiB" << std::setw(14) << "peak KiB" << "\n";
+    const std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    for (const ResourceCounter *counter : sortedCounters()) {
+        out << std::left << std::setw(24) << counter->name() << std::right
+            << std::setw(10) << counter->objects() << std::setw(10) << counter->created()
+            << std::setw(14) << counter->bytes() / 1024.0 << std::setw(14) << counter->peak_bytes() / 1024.0 << "\n";
+    }
+    out.flags(flags);
+}
+
+void game::writeResourceJson(std::ostream &out, int indent)
+{
+    const std::string margin(indent, ' ');
+    out << "{\n";
+    const std::vector<const ResourceCounter*> counters = sortedCounters();
+    for (std::size_t i=0; i<counters.size(); ++i) {
+        // counter names are identifiers, they need no escaping
+        out << margin << "  \"" << counters[i]->name() << "\": {\"objects\": " << counters[i]->objects()
+            << ", \"created\": " << counters[i]->created()
+            << ", \"bytes\": " << counters[i]->bytes()
+            << ", \"peak_bytes\": " << counters[i]->peak_bytes() << "}"
+            << (i + 1 < counters.size() ? ",\n" : "\n");
+    }
+    out << margin << "}";
+}
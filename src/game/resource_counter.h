@@ -0,0 +1,125 @@
+#ifndef RESOURCE_COUNTER_H
+#define RESOURCE_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+
+namespace game {
+
+    /**
+     * @brief The ResourceCounter class tracks the live objects of one kind and the bytes they hold
+     *
+     * Owners acquire() an object when they create it and release() it with the same size when
+     * they destroy it, so a counter that does not return to zero points at a leak. Counters are
+     * meant to be static objects, they link themselves into a list that printResourceCounters()
+     * and writeResourceJson() walk. All members are safe to use from any thread.
+     */
+    class ResourceCounter
+    {
+    public:
+        explicit ResourceCounter(const char *name);
+
+        ResourceCounter(const ResourceCounter &) = delete;
+        ResourceCounter &operator=(const ResourceCounter &) = delete;
+
+        void acquire(std::size_t bytes, long objects = 1);
+        void release(std::size_t bytes, long objects = 1);
+
+        const char *name() const {
+            return name_;
+        }
+        long objects() const {
+            return objects_.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief created counts every object ever acquired
+         */
+        long created() const {
+            return created_.load(std::memory_order_relaxed);
+        }
+        long long bytes() const {
+            return bytes_.load(std::memory_order_relaxed);
+        }
+        long long peak_bytes() const {
+            return peak_bytes_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief first starts the list of all counters, in no particular order
+         */
+        static const ResourceCounter *first();
+        const ResourceCounter *next() const {
+            return next_;
+        }
+    private:
+        const char *name_;
+        std::atomic<long> objects_;
+        std::atomic<long> created_;
+        std::atomic<long long> bytes_;
+        std::atomic<long long> peak_bytes_;
+        const ResourceCounter *next_;
+    };
+
+    /**
+     * @brief The CountingAllocator class lets standard containers report their memory to a
+     * ResourceCounter, every allocation counts as one object
+     */
+    template <typename T, ResourceCounter &Counter>
+    class CountingAllocator
+    {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind {
+            typedef CountingAllocator<U, Counter> other;
+        };
+
+        CountingAllocator() {
+        }
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U, Counter> &) {
+        }
+
+        T *allocate(std::size_t count) {
+            T *memory = std::allocator<T>().allocate(count);
+            Counter.acquire(count * sizeof(T));
+            return memory;
+        }
+        void deallocate(T *memory, std::size_t count) {
+            Counter.release(count * sizeof(T));
+            std::allocator<T>().deallocate(memory, count);
+        }
+    };
+
+    template <typename T, typename U, ResourceCounter &Counter>
+    bool operator==(const CountingAllocator<T, Counter> &, const CountingAllocator<U, Counter> &)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, ResourceCounter &Counter>
+    bool operator!=(const CountingAllocator<T, Counter> &, const CountingAllocator<U, Counter> &)
+    {
+        return false;
+    }
+
+    /**
+     * @brief printResourceCounters writes the live objects, bytes and peak bytes of every
+     * counter in a human readable table
+     */
+    void printResourceCounters(std::ostream &out);
+
+    /**
+     * @brief writeResourceJson writes every counter as a JSON object keyed by counter name
+     * @param indent the number of spaces the lines after the first are indented by, such that
+     * the object can be nested into another one
+     */
+    void writeResourceJson(std::ostream &out, int indent = 0);
+
+}
+
+#endif // RESOURCE_COUNTER_H
@@ -0,0 +1,55 @@
+#include "simulation_thread.h"
+
+#include <chrono>
+
+#include "fixed_step.h"
+
+using namespace game;
+
+SimulationThread::SimulationThread(World &world, InputQueue *input, int player)
+    : world_(world),
+      input_(input),
+      player_(player),
+      snapshots_(world.snapshot()),
+      running_(true),
+      thread_(&SimulationThread::run, this)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+    running_ = false;
+    thread_.join();
+}
+
+const WorldSnapshot &SimulationThread::latest()
+{
+    snapshots_.consume();
+    return snapshots_.front();
+}
+
+void SimulationThread::run()
+{
+    typedef std::chrono::steady_clock Clock;
+    FixedStep step(World::tick_seconds);
+    Clock::time_point previous_time = Clock::now();
+    while (running_) {
+        const Clock::time_point now = Clock::now();
+        int ticks = step.advance(std::chrono::duration<double>(now - previous_time).count());
+        previous_time = now;
+        if (ticks > 0) {
+            for (; ticks > 0; --ticks) {
+                if (input_) {
+                    // events after the due time of a tick that is caught up belong to the next one
+                    const std::chrono::duration<double> behind(step.step_seconds() * (ticks - 1));
+                    world_.control(player_, input_->consume(now - std::chrono::duration_cast<Clock::duration>(behind)));
+                }
+                world_.update();
+            }
+            world_.update_snapshot(snapshots_.back());
+            snapshots_.publish();
+        }
+        // sleep until the next tick is due
+        std::this_thread::sleep_for(std::chrono::duration<double>(step.step_seconds() * (1.0 - step.alpha())));
+    }
+}
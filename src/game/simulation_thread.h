@@ -0,0 +1,50 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+
+#include <atomic>
+#include <thread>
+
+#include "input_queue.h"
+#include "triple_buffer.h"
+#include "world.h"
+
+namespace game {
+
+    /**
+     * @brief The SimulationThread class runs World::update() at the fixed tick rate on its own
+     * thread and publishes a WorldSnapshot after every simulated frame
+     *
+     * While the thread runs it has exclusive access to the world, other threads only read
+     * the snapshots returned by latest(). Given an InputQueue, the thread is its consumer and
+     * controls the player with it before every tick.
+     */
+    class SimulationThread
+    {
+    public:
+        explicit SimulationThread(World &world, InputQueue *input = nullptr, int player = -1);
+        ~SimulationThread();
+
+        SimulationThread(const SimulationThread &) = delete;
+        SimulationThread &operator=(const SimulationThread &) = delete;
+
+        /**
+         * @brief latest returns the newest published snapshot, from a single reader thread
+         *
+         * The snapshot stays valid and unchanged until the next call.
+         */
+        const WorldSnapshot &latest();
+
+    private:
+        void run();
+
+        World &world_;
+        InputQueue *input_;
+        int player_;
+        TripleBuffer<WorldSnapshot> snapshots_;
+        std::atomic<bool> running_;
+        std::thread thread_;
+    };
+
+}
+
+#endif // SIMULATION_THREAD_H
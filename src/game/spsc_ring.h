@@ -0,0 +1,76 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace game {
+
+    /**
+     * @brief The SpscRing class is a bounded FIFO from one producer thread to one consumer
+     * thread without locks
+     *
+     * The producer only writes tail_ and the consumer only writes head_, each side reads the
+     * index of the other to tell whether there is room or data, so neither ever waits. The
+     * indices live on separate cache lines so that the two threads do not contend for one.
+     * Capacity has to be a power of two, the ring holds up to Capacity values.
+     */
+    template <typename T, std::size_t Capacity>
+    class SpscRing
+    {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "the capacity must be a power of two");
+    public:
+        SpscRing()
+            : head_(0),
+              tail_(0)
+        {
+        }
+
+        SpscRing(const SpscRing &) = delete;
+        SpscRing &operator=(const SpscRing &) = delete;
+
+        /**
+         * @brief push appends a value, producer thread only
+         * @return false if the ring is full, the value is dropped then
+         */
+        bool push(const T &value) {
+            const std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            slots_[tail & (Capacity - 1)] = value;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief front gives the oldest value, consumer thread only
+         * @return nullptr if the ring is empty, otherwise the value stays valid until pop()
+         */
+        const T *front() const {
+            const std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return &slots_[head & (Capacity - 1)];
+        }
+
+        /**
+         * @brief pop removes the value returned by front(), consumer thread only
+         */
+        void pop() {
+            head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        static constexpr std::size_t capacity() {
+            return Capacity;
+        }
+    private:
+        alignas(64) std::atomic<std::size_t> head_;
+        alignas(64) std::atomic<std::size_t> tail_;
+        alignas(64) T slots_[Capacity];
+    };
+
+}
+
+#endif // SPSC_RING_H
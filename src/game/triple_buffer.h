@@ -0,0 +1,80 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+namespace game {
+
+    /**
+     * @brief The TripleBuffer class hands values from one writer thread to one reader thread
+     * without locks
+     *
+     * The writer fills back() and publish()es it, the reader calls consume() and then reads
+     * front(). Publishing and consuming only swap slot indices through one atomic, so neither
+     * side ever waits for the other and the reader always sees the latest published value.
+     * Values the reader skipped are simply overwritten.
+     *
+     * Each slot keeps its contents when it is handed around, which allows the writer to bring
+     * a stale back() up to date incrementally instead of rebuilding it.
+     */
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        explicit TripleBuffer(const T &initial)
+            : slots_{initial, initial, initial},
+              back_(0),
+              middle_(1),
+              front_(2)
+        {
+        }
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        /**
+         * @brief back is the slot the writer prepares the next value in, writer thread only
+         */
+        T &back() {
+            return slots_[back_];
+        }
+
+        /**
+         * @brief publish makes back() the latest value and gives the writer a new back slot,
+         * writer thread only
+         */
+        void publish() {
+            back_ = middle_.exchange(back_ | fresh_bit, std::memory_order_acq_rel) & index_mask;
+        }
+
+        /**
+         * @brief consume moves the latest published value to front(), reader thread only
+         * @return false if nothing was published since the last call, front() is unchanged then
+         */
+        bool consume() {
+            if ((middle_.load(std::memory_order_acquire) & fresh_bit) == 0) {
+                return false;
+            }
+            front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask;
+            return true;
+        }
+
+        /**
+         * @brief front is the value the reader currently holds, reader thread only
+         */
+        const T &front() const {
+            return slots_[front_];
+        }
+    private:
+        static constexpr int index_mask = 3;
+        static constexpr int fresh_bit = 4;
+
+        T slots_[3];
+        int back_;
+        std::atomic<int> middle_;
+        int front_;
+    };
+
+}
+
+#endif // TRIPLE_BUFFER_H
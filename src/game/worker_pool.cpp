@@ -0,0 +1,69 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace game;
+
+int WorkerPool::default_thread_count()
+{
+    return std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+}
+
+WorkerPool::WorkerPool(int thread_count)
+    : active_(0),
+      stopping_(false)
+{
+    for (int i=0; i<std::max(thread_count, 1); ++i) {
+        threads_.push_back(std::thread(&WorkerPool::run, this));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    work_available_.notify_all();
+    for (std::thread &thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    work_available_.notify_one();
+}
+
+void WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return jobs_.empty() && active_ == 0; });
+}
+
+void WorkerPool::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        ++active_;
+        lock.unlock();
+        job();
+        lock.lock();
+        --active_;
+        if (jobs_.empty() && active_ == 0) {
+            idle_.notify_all();
+        }
+    }
+}
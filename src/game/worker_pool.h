@@ -0,0 +1,60 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace game {
+
+    /**
+     * @brief The WorkerPool class runs jobs on a fixed number of threads
+     *
+     * Jobs are started in the order they were submitted. Destroying the pool waits for the
+     * jobs that are running and drops the ones that have not started yet.
+     */
+    class WorkerPool
+    {
+    public:
+        typedef std::function<void()> Job;
+
+        /**
+         * @brief default_thread_count leaves one hardware thread to the main loop
+         */
+        static int default_thread_count();
+
+        explicit WorkerPool(int thread_count = default_thread_count());
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void submit(Job job);
+
+        /**
+         * @brief wait blocks until every submitted job has finished
+         */
+        void wait();
+
+        int thread_count() const {
+            return static_cast<int>(threads_.size());
+        }
+
+    private:
+        void run();
+
+        std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::condition_variable idle_;
+        std::deque<Job> jobs_;
+        int active_;
+        bool stopping_;
+        std::vector<std::thread> threads_;
+    };
+
+}
+
+#endif // WORKER_POOL_H
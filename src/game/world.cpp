@@ -0,0 +1,225 @@
+#include "world.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "byte_stream.h"
+#include "cell_traits.h"
+
+using namespace game;
+
+constexpr double World::tick_seconds;
+constexpr float World::tank_half_size;
+constexpr float World::bullet_half_size;
+constexpr float World::tank_speed;
+constexpr float World::bullet_speed;
+
+namespace {
+
+// tags bullets in the user values of the spatial hash, tanks are stored as plain indices
+constexpr std::uint32_t bullet_flag = 0x80000000u;
+
+}
+
+World::World(int map_size)
+    : map_(map_size),
+      tick_(0)
+{
+}
+
+World::World(Map map)
+    : map_(std::move(map)),
+      tick_(0)
+{
+}
+
+void World::update()
+{
+    tanks_.integrate(tick_seconds);
+    bullets_.integrate(tick_seconds);
+    collide_with_map();
+    collide_entities();
+    arena_.reset();
+    ++tick_;
+}
+
+int World::add_player()
+{
+    const int player = player_count();
+    const int col = map_.col_count() > 0 ? (player * 4 + 2) % map_.col_count() : 0;
+    Player added = {tanks_.spawn(col + 0.5f, 0.5f, Up, 0.0f, 3), 0};
+    players_.push_back(added);
+    return player;
+}
+
+void World::control(int player, std::uint8_t buttons)
+{
+    Player &controlled = players_[player];
+    const std::uint8_t pressed = buttons & ~controlled.buttons;
+    controlled.buttons = buttons;
+    const int index = tanks_.index_of(controlled.tank);
+    if (index < 0) {
+        return;
+    }
+    const Buttons directions[] = {ButtonUp, ButtonRight, ButtonDown, ButtonLeft};
+    Direction direction = tanks_.direction()[index];
+    float speed = 0.0f;
+    for (int i=0; i<4; ++i) {
+        if (buttons & directions[i]) {
+            direction = static_cast<Direction>(i);
+            speed = tank_speed;
+            break;
+        }
+    }
+    tanks_.steer(index, direction, speed);
+    if (pressed & ButtonFire) {
+        const float offset = tank_half_size + bullet_half_size;
+        const float dx[] = {0.0f, offset, 0.0f, -offset};
+        const float dy[] = {offset, 0.0f, -offset, 0.0f};
+        bullets_.spawn(tanks_.x()[index] + dx[direction], tanks_.y()[index] + dy[direction],
+                       direction, bullet_speed, 1);
+    }
+}
+
+void World::write_state(ByteWriter &out) const
+{
+    out.varint(tick_);
+    out.varint(players_.size());
+    for (const Player &player : players_) {
+        out.u32(player.tank);
+        out.u8(player.buttons);
+    }
+    tanks_.write(out);
+    bullets_.write(out);
+    pickups_.write(out);
+}
+
+bool World::read_state(ByteReader &in)
+{
+    tick_ = in.varint();
+    const std::size_t player_count = in.varint();
+    if (player_count > in.remaining()) {
+        return false;
+    }
+    players_.resize(player_count);
+    for (Player &player : players_) {
+        player.tank = in.u32();
+        player.buttons = in.u8();
+    }
+    return tanks_.read(in) && bullets_.read(in) && pickups_.read(in);
+}
+
+void World::despawn(EntityStore &store, const ArenaVector<EntityStore::Id> &ids)
+{
+    for (EntityStore::Id id : ids) {
+        store.despawn(id);
+    }
+}
+
+void World::collide_with_map()
+{
+    float *x = tanks_.x();
+    float *y = tanks_.y();
+    const float *previous_x = tanks_.previous_x();
+    const float *previous_y = tanks_.previous_y();
+    for (int i=0; i<tanks_.size(); ++i) {
+        const float dx = x[i] - previous_x[i];
+        const float dy = y[i] - previous_y[i];
+        const Sweep hit = sweep(map_, boxAround(previous_x[i], previous_y[i], tank_half_size),
+                                dx, dy, Collider::Tank);
+        if (hit.time < 1.0f) {
+            x[i] = previous_x[i] + dx * hit.time;
+            y[i] = previous_y[i] + dy * hit.time;
+        }
+    }
+
+    // reserving the worst case keeps the arena use of a tick a function of the entity counts,
+    // so it does not grow again once the first tick has sized the arena
+    ArenaVector<EntityStore::Id> removed((ArenaAllocator<EntityStore::Id>(arena_)));
+    removed.reserve(bullets_.size());
+    x = bullets_.x();
+    y = bullets_.y();
+    previous_x = bullets_.previous_x();
+    previous_y = bullets_.previous_y();
+    for (int i=0; i<bullets_.size(); ++i) {
+        const Sweep hit = sweep(map_, boxAround(previous_x[i], previous_y[i], bullet_half_size),
+                                x[i] - previous_x[i], y[i] - previous_y[i], Collider::Bullet);
+        if (hit.time < 1.0f) {
+            if (hit.row >= 0 && hit.col >= 0 && hit.row < map_.row_count() && hit.col < map_.col_count()) {
+                const CellProperties &cell = cellProperties(map_.cell(hit.row, hit.col));
+                if (cell.destructible) {
+                    map_.set_cell(hit.row, hit.col, cell.debris);
+                }
+            }
+            removed.push_back(bullets_.ids()[i]);
+        }
+    }
+    despawn(bullets_, removed);
+}
+
+void World::collide_entities()
+{
+    hash_.clear();
+    for (int i=0; i<tanks_.size(); ++i) {
+        hash_.insert(i, boxAround(tanks_.x()[i], tanks_.y()[i], tank_half_size));
+    }
+    for (int i=0; i<bullets_.size(); ++i) {
+        hash_.insert(i | bullet_flag, boxAround(bullets_.x()[i], bullets_.y()[i], bullet_half_size));
+    }
+    hash_.build();
+
+    // tanks look for what they touch, so piles of bullets are never tested among themselves
+    ArenaVector<std::uint8_t> spent(bullets_.size(), 0, ArenaAllocator<std::uint8_t>(arena_));
+    ArenaVector<std::uint8_t> blocked(tanks_.size(), 0, ArenaAllocator<std::uint8_t>(arena_));
+    std::int16_t *health = tanks_.health();
+    for (int tank=0; tank<tanks_.size(); ++tank) {
+        hash_.query(boxAround(tanks_.x()[tank], tanks_.y()[tank], tank_half_size), [&](std::uint32_t user) {
+            if ((user & bullet_flag) == 0) {
+                blocked[tank] |= user != static_cast<std::uint32_t>(tank);
+            } else if (!spent[user & ~bullet_flag]) {
+                spent[user & ~bullet_flag] = 1;
+                --health[tank];
+            }
+        });
+    }
+    float *x = tanks_.x();
+    float *y = tanks_.y();
+    for (int tank=0; tank<tanks_.size(); ++tank) {
+        if (blocked[tank]) {
+            x[tank] = tanks_.previous_x()[tank];
+            y[tank] = tanks_.previous_y()[tank];
+        }
+    }
+
+    // despawning reorders the columns, so collect the ids before removing anything
+    ArenaVector<EntityStore::Id> removed((ArenaAllocator<EntityStore::Id>(arena_)));
+    removed.reserve(std::max(bullets_.size(), tanks_.size()));
+    for (int i=0; i<bullets_.size(); ++i) {
+        if (spent[i]) {
+            removed.push_back(bullets_.ids()[i]);
+        }
+    }
+    despawn(bullets_, removed);
+    removed.clear();
+    for (int i=0; i<tanks_.size(); ++i) {
+        if (health[i] <= 0) {
+            removed.push_back(tanks_.ids()[i]);
+        }
+    }
+    despawn(tanks_, removed);
+}
+
+WorldSnapshot World::snapshot() const
+{
+    WorldSnapshot snapshot = {map_, tick_, tanks_, bullets_, pickups_};
+    return snapshot;
+}
+
+void World::update_snapshot(WorldSnapshot &snapshot) const
+{
+    snapshot.map.update_from(map_);
+    snapshot.tick = tick_;
+    snapshot.tanks = tanks_;
+    snapshot.bullets = bullets_;
+    snapshot.pickups = pickups_;
+}
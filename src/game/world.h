@@ -0,0 +1,183 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <cstdint>
+#include <vector>
+
+#include "broadphase.h"
+#include "entities.h"
+#include "frame_arena.h"
+#include "map.h"
+
+namespace game {
+
+    class ByteReader;
+    class ByteWriter;
+
+    /**
+     * @brief The Buttons enum are the bits of the input of one player for one tick
+     */
+    enum Buttons : std::uint8_t {
+        ButtonUp = 1,
+        ButtonRight = 2,
+        ButtonDown = 4,
+        ButtonLeft = 8,
+        ButtonFire = 16
+    };
+
+    /**
+     * @brief The WorldSnapshot struct is a copy of the world state as of one tick, for readers
+     * that must not touch the live World, such as a render thread
+     */
+    struct WorldSnapshot {
+        Map map;
+        std::uint64_t tick;
+        EntityStore tanks;
+        EntityStore bullets;
+        EntityStore pickups;
+    };
+
+    /**
+     * @brief The World class owns the complete simulation state and advances it in fixed ticks
+     *
+     * The state only changes in update(), which always simulates exactly tick_seconds, so the
+     * outcome of a match does not depend on the frame rate of the display it runs on.
+     *
+     * Movement is resolved against the map with sweep(), so tanks stop at walls and water and
+     * bullets despawn at the first solid cell, breaking it if it is clay. Entities are then
+     * tested against each other through a SpatialHash: bullets damage the tanks they hit and
+     * tanks running into each other keep their previous positions.
+     *
+     * Temporary lists of a tick come from a FrameArena that is reset at the end of update(),
+     * so once the entity counts settle a tick does not allocate.
+     *
+     * Players drive a tank each through control(). Given the same map, the same players and
+     * the same buttons every tick, update() produces the same state on every machine, which
+     * lets networked matches exchange only the buttons, see net::LockstepServer.
+     */
+    class World
+    {
+    public:
+        static constexpr double tick_seconds = 1.0 / 60.0;
+        static constexpr float tank_half_size = 0.5f;
+        static constexpr float bullet_half_size = 0.125f;
+        static constexpr float tank_speed = 2.0f;
+        static constexpr float bullet_speed = 8.0f;
+
+        World(int map_size);
+        explicit World(Map map);
+
+        /**
+         * @brief update advances the simulation by one tick of tick_seconds
+         */
+        void update();
+
+        /**
+         * @brief add_player spawns a tank for a new player at the bottom of the map
+         * @return the index of the player
+         */
+        int add_player();
+
+        int player_count() const {
+            return static_cast<int>(players_.size());
+        }
+
+        /**
+         * @brief player_tank gives the tank of a player, which is not alive once destroyed
+         */
+        EntityStore::Id player_tank(int player) const {
+            return players_[player].tank;
+        }
+
+        /**
+         * @brief control applies the buttons a player holds during the next update()
+         *
+         * A direction button drives the tank that way, none stops it. Pressing fire shoots
+         * one bullet, holding it does not shoot again.
+         */
+        void control(int player, std::uint8_t buttons);
+        /**
+         * @brief buttons gives what a player was last controlled with
+         */
+        std::uint8_t buttons(int player) const {
+            return players_[player].buttons;
+        }
+
+        /**
+         * @brief write_state stores the tick, the players and all entities, but not the map
+         */
+        void write_state(ByteWriter &out) const;
+
+        /**
+         * @brief read_state restores what write_state() stored
+         * @return false if the data is invalid, the state is undefined then
+         */
+        bool read_state(ByteReader &in);
+
+        Map &map() {
+            return map_;
+        }
+        const Map &map() const {
+            return map_;
+        }
+
+        EntityStore &tanks() {
+            return tanks_;
+        }
+        const EntityStore &tanks() const {
+            return tanks_;
+        }
+        EntityStore &bullets() {
+            return bullets_;
+        }
+        const EntityStore &bullets() const {
+            return bullets_;
+        }
+        EntityStore &pickups() {
+            return pickups_;
+        }
+        const EntityStore &pickups() const {
+            return pickups_;
+        }
+
+        std::uint64_t tick() const {
+            return tick_;
+        }
+
+        /**
+         * @brief snapshot copies the complete current state
+         */
+        WorldSnapshot snapshot() const;
+
+        /**
+         * @brief update_snapshot brings an older snapshot of this world up to date
+         *
+         * Only map chunks that changed since the snapshot was taken are copied, the entity
+         * columns are copied into the storage the snapshot already has.
+         */
+        void update_snapshot(WorldSnapshot &snapshot) const;
+    private:
+        struct Player {
+            EntityStore::Id tank;
+            std::uint8_t buttons;
+        };
+
+        void collide_with_map();
+        void collide_entities();
+        void despawn(EntityStore &store, const ArenaVector<EntityStore::Id> &ids);
+
+        Map map_;
+        std::uint64_t tick_;
+        EntityStore tanks_;
+        EntityStore bullets_;
+        EntityStore pickups_;
+        std::vector<Player> players_;
+
+        // the spatial hash keeps its buffers between ticks, everything else uses the arena
+        SpatialHash hash_;
+        FrameArena arena_;
+    };
+
+}
+
+#endif // WORLD_H
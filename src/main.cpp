@@ -1,284 +1,442 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <vector>
 #include <memory>
+#include <string>
+#include <thread>
+#include <utility>
 
 #define GLEW_STATIC
 #include <GL/glew.h>
 
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
+#include <glm/glm.hpp>
 
 #include <GLFW/glfw3.h>
 
+#include <game/fixed_step.h>
+#include <game/input_queue.h>
 #include <game/map.h>
+#include <game/replay.h>
+#include <game/simulation_thread.h>
+#include <game/world.h>
+
+#include <net/lockstep_client.h>
+#include <net/lockstep_server.h>
+#include <net/udp_socket.h>
+
+#include <render/asset_loader.h>
+#include <render/entity_renderer.h>
+#include <render/map_renderer.h>
+#include <render/profiler.h>
+#include <render/program_cache.h>
+#include <render/projection.h>
+#include <render/render_queue.h>
+#include <render/render_target.h>
 
 
 // Function prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
-void window_size_callback(GLFWwindow* window, int width, int height);
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
 struct WindowState {
+    // the size of the window when created, then that of its framebuffer in pixels, which
+    // differs from the window size on high-DPI displays
     GLuint width = 800;
     GLuint height = 600;
+    // set by framebuffer_size_callback, cleared once the projection has been recomputed
+    bool resized = true;
 } window_state;
 
-// Shaders
-const GLchar* vertexShaderSource = "#version 330 core\n"
-    "layout (location = 0) in vec3 position;\n"
-    "uniform mat4 viewMatrix;\n"
-    "void main()\n"
-    "{\n"
-    "gl_Position = viewMatrix * vec4(position, 1.0);\n"
-    "}\0";
-const GLchar* fragmentShaderSource = "#version 330 core\n"
-    "out vec4 color;\n"
-    "void main()\n"
-    "{\n"
-    "color = vec4(0.0f, 1.0f, 0.0f, 1.0f);\n"
-    "}\n\0";
+// filled by key_callback while polling events, consumed by whichever thread runs the simulation
+game::InputQueue input_queue;
+
+// the share of a frame the asset loader may spend finishing loaded assets
+const double asset_budget_seconds = 0.002;
 
 /**
- * @brief computeOrthoMatrix creates an orthographic projection matrix for 2D rendering
+ * @brief The GameOptions struct holds the command line configuration of the game
+ *
+ * mode selects how the main loop paces its frames:
+ * VSync waits for the display in glfwSwapBuffers, Uncapped renders as fast as possible and
+ * Limited sleeps after each frame to hold max_fps. The simulation always runs at
+ * game::World::tick_seconds, independently of the chosen mode.
  *
- * The function takes the aspect ratio into account, such that content fits all window
- * configurations, such as narrow and tall, or wide and thin
- * @param width the width of the window
- * @param height the height of the window, must be greater than 1
- * @return a glm::mat4x4 matrix object that describes the orthographic projection transformation
+ * When profile is set or profile_csv names a file, the frame profiler statistics are
+ * written to stdout or to that file on exit. profile_json names a file for the same
+ * statistics together with the memory and GL resource counters. level names a binary level file to play,
+ * an empty 10x10 map is used otherwise. simulation_thread moves the simulation to a
+ * thread of its own, which publishes snapshots for rendering. shader_cache names the file
+ * that keeps linked shader programs between runs, an empty name disables it.
+ *
+ * host_port runs a lockstep server on that UDP port with a local player, connect joins the
+ * server at HOST:PORT instead. Both need the same level, networked matches do not use a
+ * simulation thread.
+ *
+ * replay names a replay file to watch at its recorded speed instead of playing, record
+ * names the file the match is recorded to, locally or as the host of a networked match.
+ * map_mode selects the render::MapRenderer strategy. render_scale and msaa_samples set the
+ * resolution and multisampling of the offscreen render::RenderTarget frames are drawn to.
  */
-glm::mat4x4 computeOrthoMatrix(int width, int height)
-{
-    assert(height > 0);
-    float ratio = static_cast<float>(width) / height;
-    if (ratio > 1.0) {
-        return glm::ortho(-ratio, ratio, -1.0f, 1.0f);
-    }
-    return glm::ortho(-1.0f, 1.0f, -1/ratio, 1/ratio);
-}
-
-
-class Shader {
-public:
-    enum ShaderType {
-        Vertex = GL_VERTEX_SHADER,
-        Fragment = GL_FRAGMENT_SHADER
+struct GameOptions {
+    enum SwapMode {
+        VSync,
+        Uncapped,
+        Limited
     };
 
-    virtual ~Shader()
-    {
-        if (shader_ != 0) {
-            glDeleteShader(shader_);
-        }
-    }
-
-    GLuint gl_ref() const
-    {
-        return shader_;
-    }
-
-protected:
-    Shader(ShaderType shaderType, const GLchar* shaderSource): shader_(0)
-    {
-        shader_source_ = shaderSource;
-        shader_type_ = shaderType;
-
-        std::cout << "creating shader" << shaderType << std::endl;
-
-        shader_ = glCreateShader(shader_type_);
-        glShaderSource(shader_, 1, &shader_source_, NULL);
-        glCompileShader(shader_);
-        GLint success;
-        GLchar info_log[512];
-        glGetShaderiv(shader_, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(shader_, 512, NULL, info_log);
-            std::cout << "ERROR::SHADER::" << shader_type_ << "::COMPILATION_FAILED\n" << info_log << std::endl;
-        }
-    }
-
-private:
-    ShaderType shader_type_;
-    const GLchar *shader_source_;
-    GLuint shader_;
-};
-
-
-class VertexShader: public Shader {
-public:
-    VertexShader(const GLchar* shaderSource)
-        :Shader(ShaderType::Vertex, shaderSource)
-    {
-    }
-};
-
-
-class FragmentShader: public Shader {
-public:
-    FragmentShader(const GLchar* shaderSource)
-        :Shader(ShaderType::Fragment, shaderSource)
-    {
-    }
+    SwapMode mode = SwapMode::VSync;
+    double max_fps = 60.0;
+    bool profile = false;
+    std::string profile_csv;
+    std::string profile_json;
+    std::string level;
+    bool simulation_thread = false;
+    std::string shader_cache = "BattleCity.shadercache";
+    int host_port = 0;
+    std::string connect;
+    std::string replay;
+    std::string record;
+    render::MapRenderer::Mode map_mode = render::MapRenderer::Instanced;
+    float render_scale = 1.0f;
+    int msaa_samples = 0;
 };
 
-
-class Program {
-public:
-    Program(const std::vector<Shader*> &shaders)
-        : shaders_(shaders),
-          program_(0)
-    {
-        // Link shaders
-        program_ = glCreateProgram();
-        for (auto it=shaders.begin(); it != shaders.end(); it++) {
-            glAttachShader(program_, (*it)->gl_ref());
-        }
-        glLinkProgram(program_);
-        // Check for linking errors
-        GLint success;
-        GLchar info_log[512];
-        glGetProgramiv(program_, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(program_, 512, NULL, info_log);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << info_log << std::endl;
-        }
-    }
-
-    GLuint gl_ref()
-    {
-        return program_;
-    }
-
-    virtual ~Program()
-    {
-        if (program_ != 0) {
-            glDeleteProgram(program_);
+/**
+ * @brief parseGameOptions reads the game options from the command line
+ *
+ * Recognized arguments are --vsync, --uncapped and --fps=N, the last one wins, as well as
+ * --profile, --profile-csv=FILE, --profile-json=FILE, --level=FILE, --simulation-thread,
+ * --shader-cache=FILE, --host=PORT, --connect=HOST:PORT, --replay=FILE, --record=FILE,
+ * --map-mode=NAME, where NAME is one of the render::MapRenderer::mode_name() values,
+ * --render-scale=F and --msaa=N.
+ * @return the selected options, VSync if none were given
+ */
+GameOptions parseGameOptions(int argc, char *argv[])
+{
+    GameOptions options;
+    for (int i=1; i<argc; ++i) {
+        if (std::strcmp(argv[i], "--vsync") == 0) {
+            options.mode = GameOptions::VSync;
+        } else if (std::strcmp(argv[i], "--uncapped") == 0) {
+            options.mode = GameOptions::Uncapped;
+        } else if (std::strncmp(argv[i], "--fps=", 6) == 0 && std::atof(argv[i] + 6) > 0.0) {
+            options.mode = GameOptions::Limited;
+            options.max_fps = std::atof(argv[i] + 6);
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            options.profile = true;
+        } else if (std::strncmp(argv[i], "--profile-csv=", 14) == 0) {
+            options.profile_csv = argv[i] + 14;
+        } else if (std::strncmp(argv[i], "--profile-json=", 15) == 0) {
+            options.profile_json = argv[i] + 15;
+        } else if (std::strncmp(argv[i], "--level=", 8) == 0) {
+            options.level = argv[i] + 8;
+        } else if (std::strcmp(argv[i], "--simulation-thread") == 0) {
+            options.simulation_thread = true;
+        } else if (std::strncmp(argv[i], "--shader-cache=", 15) == 0) {
+            options.shader_cache = argv[i] + 15;
+        } else if (std::strncmp(argv[i], "--host=", 7) == 0 && std::atoi(argv[i] + 7) > 0) {
+            options.host_port = std::atoi(argv[i] + 7);
+        } else if (std::strncmp(argv[i], "--connect=", 10) == 0) {
+            options.connect = argv[i] + 10;
+        } else if (std::strncmp(argv[i], "--replay=", 9) == 0) {
+            options.replay = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--record=", 9) == 0) {
+            options.record = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--map-mode=", 11) == 0) {
+            bool known = false;
+            for (int mode=render::MapRenderer::PerCell; mode<=render::MapRenderer::Baked; ++mode) {
+                if (std::strcmp(argv[i] + 11, render::MapRenderer::mode_name(static_cast<render::MapRenderer::Mode>(mode))) == 0) {
+                    options.map_mode = static_cast<render::MapRenderer::Mode>(mode);
+                    known = true;
+                }
+            }
+            if (!known) {
+                std::cerr << "ignoring unknown map mode " << argv[i] + 11 << "\n";
+            }
+        } else if (std::strncmp(argv[i], "--render-scale=", 15) == 0 && std::atof(argv[i] + 15) > 0.0) {
+            options.render_scale = static_cast<float>(std::atof(argv[i] + 15));
+        } else if (std::strncmp(argv[i], "--msaa=", 7) == 0 && std::atoi(argv[i] + 7) >= 0) {
+            options.msaa_samples = std::atoi(argv[i] + 7);
+        } else {
+            std::cerr << "ignoring unknown argument " << argv[i] << "\n";
         }
     }
+    return options;
+}
 
-private:
-    std::vector<Shader*> shaders_;
-    GLuint program_;
-};
-
-
-class MapRenderer {
-public:
-    MapRenderer(const game::Map &map, glm::mat4x4 &ortho)
-        : map_(map),
-          ortho_(ortho),
-          vertexShader_(vertexShaderSource),
-          fragmentShader_(fragmentShaderSource),
-          program_({&vertexShader_, &fragmentShader_})
-    {
-        glGenVertexArrays(1, &cellVao_);
-        glGenBuffers(1, &cellVbo_);
-        glBindVertexArray(cellVao_);
-
-        glBindBuffer(GL_ARRAY_BUFFER, cellVbo_);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-        glEnableVertexAttribArray(0);
 
-        glBindVertexArray(0);
+int main(int argc, char *argv[])
+{
+    GameOptions options = parseGameOptions(argc, argv);
+    const bool networked = options.host_port > 0 || !options.connect.empty();
+    if ((networked || !options.replay.empty() || !options.record.empty()) && options.simulation_thread) {
+        std::cerr << "networked matches, replays and recordings run the simulation on the main thread\n";
+        options.simulation_thread = false;
     }
-
-    void render()
-    {
-        GLint viewMatrixLocation = glGetUniformLocation(program_.gl_ref(), "viewMatrix");
-        glUseProgram(program_.gl_ref());
-        glBindVertexArray(cellVao_);
-        for (int i=0; i<map_.row_count(); ++i) {
-            for (int j=0; j<map_.col_count(); ++j) {
-                glm::mat4 cellTranslate = glm::translate(glm::mat4(1.0f),
-                                                         glm::vec3((j - (map_.col_count()-1)/2.0)*2,
-                                                                   (i - (map_.row_count()-1)/2.0)*2,
-                                                                   0));
-                float scaleFactor = 1.0f / map_.row_count();
-                glm::mat4 gridScale = glm::scale(glm::mat4(1.0f), glm::vec3(scaleFactor, scaleFactor, scaleFactor));
-                glm::mat4 viewMatrix = ortho_ * gridScale * cellTranslate;
-                glUniformMatrix4fv(viewMatrixLocation, 1, GL_FALSE, glm::value_ptr(viewMatrix));
-                glDrawArrays(GL_TRIANGLES, 0, 6);
-            }
+    std::unique_ptr<game::Replay> replay;
+    if (!options.replay.empty()) {
+        replay = game::Replay::load(options.replay);
+        if (!replay) {
+            std::cerr << "could not load replay " << options.replay << "\n";
+            return 1;
         }
-        glBindVertexArray(0);
-    }
-
-    ~MapRenderer()
-    {
-        glDeleteVertexArrays(1, &cellVao_);
-        glDeleteBuffers(1, &cellVbo_);
+        // the replay brings its own map and players
+        options.level.clear();
+        options.host_port = 0;
+        options.connect.clear();
+        options.record.clear();
     }
 
-private:
-    GLfloat vertices[18] = {
-        -1.0f, 1.0f, 0.0f,
-        -1.0f, -1.0f, 0.0f,
-        1.0f, -0.5f, 0.0f,
-        1.0f, -1.0f, 0.0f,
-        1.0f, 1.0f, 0.0f,
-        -1.0f, 1.0f, 0.0f
-    };
-
-    VertexShader vertexShader_;
-    FragmentShader fragmentShader_;
-    Program program_;
-    GLuint cellVbo_;
-    GLuint cellVao_;
-    glm::mat4x4 &ortho_;
-
-    const game::Map map_;
-};
-
-
-int main()
-{
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     GLFWwindow* window = glfwCreateWindow(window_state.width, window_state.height, "LearnOpenGL", nullptr, nullptr);
-    glfwSetWindowSizeCallback(window, window_size_callback);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwMakeContextCurrent(window);
+    int framebuffer_width, framebuffer_height;
+    glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+    framebuffer_size_callback(window, framebuffer_width, framebuffer_height);
 
     glfwSetKeyCallback(window, key_callback);
+    glfwSwapInterval(options.mode == GameOptions::VSync ? 1 : 0);
 
     glewExperimental = GL_TRUE;
     glewInit();
+    if (!options.shader_cache.empty()) {
+        render::ProgramCache::shared().open(options.shader_cache);
+    }
 
     glViewport(0, 0, window_state.width, window_state.height);
 
-    game::Map map(10);
+    // the game starts on an empty map right away, a requested level replaces it once loaded
+    game::World world(game::Map(10));
+    if (replay) {
+        world = replay->start();
+    }
+    // a local match has a player for the keyboard, networked ones add theirs in start_match
+    const bool local = !replay && !networked;
+    int local_player = local ? world.add_player() : -1;
+    float aspect = render::MapRenderer::aspect_ratio(world.map());
+    // with a simulation thread the world belongs to that thread, rendering uses its snapshots
+    std::unique_ptr<game::SimulationThread> simulation;
+    if (options.simulation_thread) {
+        simulation.reset(new game::SimulationThread(world, &input_queue, local_player));
+    }
     glm::mat4x4 ortho;
-    MapRenderer renderer(map, ortho);
+    std::unique_ptr<render::MapRenderer> renderer(
+                new render::MapRenderer(simulation ? simulation->latest().map : world.map(), ortho, options.map_mode));
+    render::EntityRenderer entity_renderer;
+    render::RenderQueue render_queue;
+    render::RenderTarget render_target;
+
+    // networking and recording start once the level is there, the world is replaced before that
+    std::unique_ptr<net::LockstepServer> server;
+    std::unique_ptr<net::LockstepClient> client;
+    std::unique_ptr<game::ReplayRecorder> recorder;
+    auto start_match = [&]() {
+        server.reset();
+        client.reset();
+        recorder.reset();
+        if (!options.record.empty() && options.connect.empty()) {
+            recorder.reset(new game::ReplayRecorder(world));
+        } else if (!options.record.empty()) {
+            std::cerr << "only the host of a networked match records it\n";
+        }
+        if (options.host_port > 0) {
+            server.reset(new net::LockstepServer(world));
+            local_player = server->add_local_player();
+            server->set_recorder(recorder.get());
+            return server->open(static_cast<std::uint16_t>(options.host_port));
+        }
+        if (!options.connect.empty()) {
+            const std::string::size_type colon = options.connect.rfind(':');
+            net::Address address;
+            if (colon == std::string::npos
+                    || !net::resolveAddress(options.connect.substr(0, colon),
+                                            static_cast<std::uint16_t>(std::atoi(options.connect.c_str() + colon + 1)),
+                                            address)) {
+                std::cerr << "could not connect to " << options.connect << "\n";
+                return false;
+            }
+            client.reset(new net::LockstepClient(world));
+            return client->connect(address);
+        }
+        return true;
+    };
+
+    render::AssetLoader assets;
+    int exit_code = 0;
+    if (options.level.empty() && !replay && !start_match()) {
+        exit_code = 1;
+        glfwSetWindowShouldClose(window, GL_TRUE);
+    }
+    if (!options.level.empty()) {
+        assets.load_level(options.level, [&](std::unique_ptr<game::Map> level) {
+            if (!level) {
+                std::cerr << "could not load level " << options.level << "\n";
+                exit_code = 1;
+                glfwSetWindowShouldClose(window, GL_TRUE);
+                return;
+            }
+            simulation.reset();
+            world = game::World(std::move(*level));
+            if (local) {
+                local_player = world.add_player();
+            }
+            if (options.simulation_thread) {
+                simulation.reset(new game::SimulationThread(world, &input_queue, local_player));
+            }
+            renderer.reset(new render::MapRenderer(simulation ? simulation->latest().map : world.map(), ortho,
+                                                   options.map_mode));
+            aspect = render::MapRenderer::aspect_ratio(world.map());
+            window_state.resized = true;
+            if (!start_match()) {
+                exit_code = 1;
+                glfwSetWindowShouldClose(window, GL_TRUE);
+            }
+        });
+    }
 
+    game::FixedStep step(game::World::tick_seconds);
+    render::FrameProfiler profiler;
+    double previous_time = glfwGetTime();
     while (!glfwWindowShouldClose(window))
     {
-        glfwPollEvents();
+        const double frame_start = glfwGetTime();
+        profiler.begin_frame();
+        const game::WorldSnapshot *snapshot = nullptr;
+        {
+            render::ProfileScope scope(profiler, render::FrameProfiler::Poll);
+            glfwPollEvents();
+        }
 
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        {
+            render::ProfileScope scope(profiler, render::FrameProfiler::Update);
+            assets.update(asset_budget_seconds);
+            if (simulation) {
+                snapshot = &simulation->latest();
+                renderer->observe(snapshot->map);
+            } else if (replay) {
+                for (int ticks = step.advance(frame_start - previous_time); ticks > 0; --ticks) {
+                    replay->step(world);
+                }
+            } else if (server) {
+                // the input delay of lockstep matches dwarfs a split of the events by tick
+                server->set_local_input(local_player, input_queue.consume(game::InputQueue::Clock::now()));
+                server->update(step.advance(frame_start - previous_time));
+            } else if (client) {
+                client->set_input(input_queue.consume(game::InputQueue::Clock::now()));
+                client->update(step.advance(frame_start - previous_time));
+            } else {
+                const game::InputQueue::Clock::time_point now = game::InputQueue::Clock::now();
+                for (int ticks = step.advance(frame_start - previous_time); ticks > 0; --ticks) {
+                    // events after the due time of a tick that is caught up belong to the next one
+                    const std::chrono::duration<double> behind(step.step_seconds() * (ticks - 1));
+                    world.control(local_player, input_queue.consume(
+                                      now - std::chrono::duration_cast<game::InputQueue::Clock::duration>(behind)));
+                    world.update();
+                    if (recorder) {
+                        recorder->record(world);
+                    }
+                }
+            }
+            previous_time = frame_start;
+        }
 
-        ortho = computeOrthoMatrix(window_state.width, window_state.height);
-        renderer.render();
+        {
+            render::ProfileScope scope(profiler, render::FrameProfiler::Render);
+            if (window_state.resized) {
+                render_target.resize(window_state.width, window_state.height,
+                                     options.render_scale, options.msaa_samples);
+                ortho = render::computeOrthoMatrix(render_target.width(), render_target.height(), aspect);
+                window_state.resized = false;
+            }
+            render_target.bind();
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            renderer->submit(render_queue, 0);
+            if (snapshot) {
+                // snapshots hold the state of a completed tick, there is nothing to interpolate
+                entity_renderer.submit(render_queue, ortho, snapshot->map, snapshot->tanks, snapshot->bullets,
+                                       snapshot->pickups, 1.0f, 1);
+            } else {
+                entity_renderer.submit(render_queue, ortho, world.map(), world.tanks(), world.bullets(),
+                                       world.pickups(), static_cast<float>(step.alpha()), 1);
+            }
+            render_queue.execute();
+            render_target.present();
+        }
 
-        glfwSwapBuffers(window);
+        {
+            render::ProfileScope scope(profiler, render::FrameProfiler::Swap);
+            glfwSwapBuffers(window);
+        }
+
+        if (options.mode == GameOptions::Limited) {
+            const double remaining = frame_start + 1.0 / options.max_fps - glfwGetTime();
+            if (remaining > 0.0) {
+                std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+            }
+        }
+        profiler.end_frame();
+    }
+
+    if (options.profile) {
+        profiler.print(std::cout);
+        const game::InputLatency latency = input_queue.latency();
+        std::cout << "input latency: " << latency.average_seconds * 1000.0 << " ms average, "
+                  << latency.max_seconds * 1000.0 << " ms max over " << latency.events << " events, "
+                  << latency.dropped << " dropped\n";
+    }
+    if (!options.profile_csv.empty() && !profiler.write_csv(options.profile_csv)) {
+        std::cerr << "could not write profile to " << options.profile_csv << "\n";
+    }
+    if (!options.profile_json.empty() && !profiler.write_json(options.profile_json)) {
+        std::cerr << "could not write profile to " << options.profile_json << "\n";
+    }
+    if (recorder && !recorder->save(options.record, world)) {
+        std::cerr << "could not write replay " << options.record << "\n";
+        exit_code = 1;
     }
     glfwTerminate();
-    return 0;
+    return exit_code;
 }
 
+/**
+ * @brief key_callback closes the window on escape and queues the arrow keys and space as the
+ * buttons of the local player
+ */
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
+    // repeats do not change what is held
+    if (action == GLFW_REPEAT)
+        return;
+    std::uint8_t button = 0;
+    if (key == GLFW_KEY_UP)
+        button = game::ButtonUp;
+    else if (key == GLFW_KEY_RIGHT)
+        button = game::ButtonRight;
+    else if (key == GLFW_KEY_DOWN)
+        button = game::ButtonDown;
+    else if (key == GLFW_KEY_LEFT)
+        button = game::ButtonLeft;
+    else if (key == GLFW_KEY_SPACE)
+        button = game::ButtonFire;
+    if (button != 0)
+        input_queue.push(button, action == GLFW_PRESS);
 }
 
-void window_size_callback(GLFWwindow* window, int width, int height)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    window_state.width = width;
+    window_state.width = width > 0 ? width : 1;
     window_state.height = height > 0 ? height : 1;
-    glViewport(0, 0, window_state.width, window_state.height);
+    // the render target sets the viewport for the new size with the next frame
+    window_state.resized = true;
 }
@@ -0,0 +1,239 @@
+#include "lockstep_client.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "map_delta.h"
+#include "protocol.h"
+
+using namespace net;
+
+namespace {
+    // the tick of commands that did not arrive
+    const std::uint64_t unknown_tick = ~static_cast<std::uint64_t>(0);
+}
+
+LockstepClient::LockstepClient(game::World &world)
+    : world_(world),
+      player_(-1),
+      synchronized_(false),
+      input_delay_(0),
+      join_wait_(0),
+      input_ack_(0),
+      next_input_(0),
+      buttons_(0),
+      snapshot_ack_(0),
+      snapshot_tick_(0),
+      snapshot_size_(0),
+      snapshot_missing_(0),
+      bytes_sent_(0),
+      packet_(max_datagram_size)
+{
+    commands_.resize(command_window);
+    for (TickCommands &commands : commands_) {
+        commands.tick = unknown_tick;
+    }
+}
+
+bool LockstepClient::connect(const Address &server, std::uint16_t local_port)
+{
+    if (!socket_.open(local_port)) {
+        return false;
+    }
+    server_ = server;
+    player_ = -1;
+    synchronized_ = false;
+    snapshot_missing_ = 0;
+    for (TickCommands &commands : commands_) {
+        commands.tick = unknown_tick;
+    }
+    send_join();
+    return true;
+}
+
+int LockstepClient::update(int due_ticks)
+{
+    receive();
+    if (player_ < 0) {
+        join_wait_ += due_ticks;
+        if (join_wait_ >= join_interval) {
+            send_join();
+        }
+        return 0;
+    }
+
+    // buttons are produced at the pace of the local clock, but never further ahead than
+    // one message can repeat, or than twice the delay once the world is running
+    for (int i=0; i<due_ticks; ++i) {
+        if (next_input_ >= input_ack_ + max_redundant_ticks
+                || (synchronized_ && next_input_ >= world_.tick() + 2 * input_delay_)) {
+            break;
+        }
+        inputs_.push_back(buttons_);
+        ++next_input_;
+    }
+
+    int simulated = 0;
+    while (synchronized_ && commands_[world_.tick() % command_window].tick == world_.tick()) {
+        const std::vector<std::uint8_t> &buttons = commands_[world_.tick() % command_window].buttons;
+        while (world_.player_count() < static_cast<int>(buttons.size())) {
+            world_.add_player();
+        }
+        for (std::size_t player=0; player<buttons.size(); ++player) {
+            world_.control(static_cast<int>(player), buttons[player]);
+        }
+        world_.update();
+        ++simulated;
+    }
+
+    if (due_ticks > 0 || simulated > 0) {
+        send_input();
+    }
+    return simulated;
+}
+
+void LockstepClient::receive()
+{
+    Address from;
+    int size;
+    while ((size = socket_.receive(packet_.data(), packet_.size(), from)) >= 0) {
+        game::ByteReader in(packet_.data(), size);
+        MessageType type;
+        if (from != server_ || !readHeader(in, type)) {
+            continue;
+        }
+        if (type == Welcome) {
+            handle_welcome(in);
+        } else if (type == Commands && synchronized_) {
+            handle_commands(in);
+        } else if (type == Snapshot && player_ >= 0) {
+            handle_snapshot(in);
+        }
+    }
+}
+
+void LockstepClient::handle_welcome(game::ByteReader &in)
+{
+    const int player = static_cast<int>(in.varint());
+    const std::uint64_t join_tick = in.varint();
+    const int input_delay = in.u8();
+    if (!in.ok() || player_ >= 0) {
+        return;
+    }
+    player_ = player;
+    input_delay_ = input_delay;
+    input_ack_ = join_tick + input_delay;
+    next_input_ = input_ack_;
+    inputs_.clear();
+}
+
+void LockstepClient::handle_commands(game::ByteReader &in)
+{
+    const std::uint64_t first = in.varint();
+    const int count = in.u8();
+    const std::uint64_t input_ack = in.varint();
+    for (int i=0; i<count && in.ok(); ++i) {
+        const std::uint64_t tick = first + i;
+        const int players = in.u8();
+        TickCommands &commands = commands_[tick % command_window];
+        if (tick < world_.tick() || tick >= world_.tick() + command_window || commands.tick == tick) {
+            std::uint8_t skipped[256];
+            in.bytes(skipped, players);
+            continue;
+        }
+        commands.buttons.resize(players);
+        commands.tick = in.bytes(commands.buttons.data(), players) ? tick : unknown_tick;
+    }
+    if (in.ok() && input_ack > input_ack_) {
+        // the server may also skip ticks of a late client, their buttons are dropped
+        const std::uint64_t acked = std::min<std::uint64_t>(input_ack - input_ack_, inputs_.size());
+        inputs_.erase(inputs_.begin(), inputs_.begin() + acked);
+        input_ack_ = input_ack;
+        next_input_ = std::max(next_input_, input_ack_);
+    }
+}
+
+void LockstepClient::handle_snapshot(game::ByteReader &in)
+{
+    const std::uint64_t tick = in.varint();
+    const int fragment = in.u8();
+    const int fragments = in.u8() + 1;
+    const std::size_t size = in.remaining();
+    // every fragment but the last is full, so the offset of each follows from its index
+    if (!in.ok() || fragment >= fragments || size > static_cast<std::size_t>(snapshot_fragment_size)
+            || (fragment + 1 < fragments && size != static_cast<std::size_t>(snapshot_fragment_size))) {
+        return;
+    }
+    // a snapshot older than the local world is of no use
+    if (synchronized_ && tick < world_.tick()) {
+        return;
+    }
+    if (snapshot_missing_ == 0 || tick != snapshot_tick_ || fragments != static_cast<int>(snapshot_fragments_.size())) {
+        // the fragments of an older snapshot still being assembled are dropped
+        if (snapshot_missing_ > 0 && tick < snapshot_tick_) {
+            return;
+        }
+        snapshot_tick_ = tick;
+        snapshot_fragments_.assign(fragments, false);
+        snapshot_missing_ = fragments;
+        snapshot_.resize(static_cast<std::size_t>(fragments) * snapshot_fragment_size);
+    }
+    if (snapshot_fragments_[fragment]) {
+        return;
+    }
+    const std::size_t offset = static_cast<std::size_t>(fragment) * snapshot_fragment_size;
+    in.bytes(snapshot_.data() + offset, size);
+    if (fragment + 1 == fragments) {
+        snapshot_size_ = offset + size;
+    }
+    snapshot_fragments_[fragment] = true;
+    if (--snapshot_missing_ == 0) {
+        game::ByteReader whole(snapshot_.data(), snapshot_size_);
+        apply_snapshot(whole);
+    }
+}
+
+void LockstepClient::apply_snapshot(game::ByteReader &in)
+{
+    const game::Map::Revision revision = in.varint();
+    if (!world_.read_state(in) || !readMapDelta(in, world_.map())) {
+        std::cerr << "could not apply a snapshot\n";
+        synchronized_ = false;
+        snapshot_ack_ = 0;
+        return;
+    }
+    synchronized_ = true;
+    snapshot_ack_ = revision + 1;
+}
+
+void LockstepClient::send_join()
+{
+    join_wait_ = 0;
+    datagram_.clear();
+    game::ByteWriter out(datagram_);
+    writeHeader(out, Join);
+    send();
+}
+
+void LockstepClient::send_input()
+{
+    datagram_.clear();
+    game::ByteWriter out(datagram_);
+    writeHeader(out, Input);
+    const int count = static_cast<int>(std::min<std::size_t>(inputs_.size(), max_redundant_ticks));
+    out.varint(input_ack_);
+    out.u8(count);
+    for (int i=0; i<count; ++i) {
+        out.u8(inputs_[i]);
+    }
+    out.varint(synchronized_ ? world_.tick() : 0);
+    out.varint(snapshot_ack_);
+    send();
+}
+
+void LockstepClient::send()
+{
+    if (socket_.send(server_, datagram_.data(), datagram_.size())) {
+        bytes_sent_ += datagram_.size();
+    }
+}
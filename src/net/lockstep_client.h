@@ -0,0 +1,126 @@
+#ifndef LOCKSTEP_CLIENT_H
+#define LOCKSTEP_CLIENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <game/map.h>
+#include <game/world.h>
+
+#include "protocol.h"
+#include "udp_socket.h"
+
+namespace net {
+
+    /**
+     * @brief The LockstepClient class runs a copy of the world of a LockstepServer
+     *
+     * The client world only advances with the commands of the server, so it is behind the
+     * server by the network latency. Its own buttons take effect input_delay ticks after they
+     * were set, which hides that latency as long as it is shorter than the delay. Snapshots
+     * replace the state of the client world when they are not older than it.
+     */
+    class LockstepClient
+    {
+    public:
+        explicit LockstepClient(game::World &world);
+
+        LockstepClient(const LockstepClient&) = delete;
+        LockstepClient &operator=(const LockstepClient&) = delete;
+
+        /**
+         * @brief connect opens a local port and asks the server for a player
+         * @return false if no socket could be opened
+         */
+        bool connect(const Address &server, std::uint16_t local_port = 0);
+
+        /**
+         * @brief joined is true once the server assigned a player and its state arrived
+         */
+        bool joined() const {
+            return player_ >= 0 && synchronized_;
+        }
+        /**
+         * @brief player is the index of the player of this client, -1 before the server replied
+         */
+        int player() const {
+            return player_;
+        }
+
+        /**
+         * @brief set_input sets the buttons sent for the ticks that become due from now on
+         */
+        void set_input(std::uint8_t buttons) {
+            buttons_ = buttons;
+        }
+
+        /**
+         * @brief update handles incoming messages, simulates the ticks with known commands
+         * and sends the buttons of the ticks that became due
+         * @param due_ticks the ticks that became due since the last call, see game::FixedStep
+         * @return the number of ticks simulated
+         */
+        int update(int due_ticks);
+
+        std::size_t bytes_sent() const {
+            return bytes_sent_;
+        }
+
+    private:
+        // the ticks between repeated join requests
+        static const int join_interval = 30;
+
+        // the ticks of commands kept ahead of the world
+        static const int command_window = 4 * max_redundant_ticks;
+
+        struct TickCommands {
+            // the tick the buttons are for, commands of a tick never change once simulated
+            std::uint64_t tick;
+            std::vector<std::uint8_t> buttons;
+        };
+
+        void receive();
+        void handle_welcome(game::ByteReader &in);
+        void handle_commands(game::ByteReader &in);
+        void handle_snapshot(game::ByteReader &in);
+        void apply_snapshot(game::ByteReader &in);
+        void send_join();
+        void send_input();
+        void send();
+
+        game::World &world_;
+        UdpSocket socket_;
+        Address server_;
+        int player_;
+        bool synchronized_;
+        int input_delay_;
+        int join_wait_;
+
+        // the buttons of this client for the ticks from input_ack_ to next_input_
+        std::deque<std::uint8_t> inputs_;
+        std::uint64_t input_ack_;
+        std::uint64_t next_input_;
+        std::uint8_t buttons_;
+
+        // the commands by tick modulo command_window, as far as they arrived, reused so that
+        // a tick does not allocate
+        std::vector<TickCommands> commands_;
+        // the map revision of the last snapshot applied, plus one, 0 for none
+        game::Map::Revision snapshot_ack_;
+        // the fragments of the snapshot of snapshot_tick_ as far as they arrived
+        std::vector<std::uint8_t> snapshot_;
+        std::vector<bool> snapshot_fragments_;
+        std::uint64_t snapshot_tick_;
+        std::size_t snapshot_size_;
+        int snapshot_missing_;
+
+        std::size_t bytes_sent_;
+        std::vector<std::uint8_t> datagram_;
+        std::vector<std::uint8_t> packet_;
+    };
+
+}
+
+#endif // LOCKSTEP_CLIENT_H
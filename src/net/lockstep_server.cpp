@@ -0,0 +1,289 @@
+#include "lockstep_server.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "map_delta.h"
+#include "protocol.h"
+
+using namespace net;
+
+namespace {
+    // the ticks between snapshots for clients that have none yet or fell behind the history
+    const std::uint64_t catch_up_interval = 8;
+}
+
+LockstepServer::LockstepServer(game::World &world, LockstepOptions options)
+    : world_(world),
+      options_(options),
+      history_(history_size),
+      history_begin_(world.tick()),
+      recorder_(nullptr),
+      budget_(0),
+      stalled_(0),
+      bytes_sent_(0),
+      packet_(max_datagram_size)
+{
+}
+
+bool LockstepServer::open(std::uint16_t port)
+{
+    return socket_.open(port);
+}
+
+int LockstepServer::add_local_player()
+{
+    if (player_count() >= max_players) {
+        return -1;
+    }
+    PlayerInput input;
+    input.local = true;
+    input.local_buttons = 0;
+    input.received_until = 0;
+    inputs_.push_back(input);
+    return world_.add_player();
+}
+
+void LockstepServer::set_local_input(int player, std::uint8_t buttons)
+{
+    if (player >= 0 && player < static_cast<int>(inputs_.size()) && inputs_[player].local) {
+        inputs_[player].local_buttons = buttons;
+    }
+}
+
+int LockstepServer::update(int due_ticks)
+{
+    receive();
+    budget_ = std::min(budget_ + due_ticks, options_.max_stall_ticks);
+    int simulated = 0;
+    while (budget_ > 0) {
+        if (inputs_ready(world_.tick())) {
+            stalled_ = 0;
+        } else if (stalled_ < options_.max_stall_ticks) {
+            stalled_ += due_ticks;
+            break;
+        }
+        step();
+        --budget_;
+        ++simulated;
+    }
+    if (simulated == 0) {
+        return 0;
+    }
+    for (Peer &peer : peers_) {
+        if (!peer.joined) {
+            continue;
+        }
+        send_commands(peer);
+        const bool behind = peer.snapshot_ack == 0 || peer.command_ack < history_begin_;
+        const std::uint64_t interval = behind
+                ? catch_up_interval : static_cast<std::uint64_t>(options_.snapshot_interval);
+        if (world_.tick() - peer.snapshot_tick >= interval) {
+            send_snapshot(peer);
+        }
+    }
+    return simulated;
+}
+
+void LockstepServer::receive()
+{
+    Address from;
+    int size;
+    while ((size = socket_.receive(packet_.data(), packet_.size(), from)) >= 0) {
+        game::ByteReader in(packet_.data(), size);
+        MessageType type;
+        if (!readHeader(in, type)) {
+            continue;
+        }
+        std::vector<Peer>::iterator peer = std::find_if(peers_.begin(), peers_.end(), [&](const Peer &p) {
+            return p.address == from;
+        });
+        if (type == Join) {
+            if (peer == peers_.end()) {
+                // the player is added at the start of the next tick, see step(), a full match
+                // ignores the request
+                if (player_count() < max_players) {
+                    Peer joining;
+                    joining.address = from;
+                    joining.player = -1;
+                    joining.joined = false;
+                    joining.join_tick = 0;
+                    joining.command_ack = 0;
+                    joining.snapshot_ack = 0;
+                    joining.snapshot_tick = 0;
+                    peers_.push_back(joining);
+                }
+            } else if (peer->joined) {
+                send_welcome(*peer);
+            }
+        } else if (type == Input && peer != peers_.end() && peer->joined) {
+            handle_input(*peer, in);
+        }
+    }
+}
+
+void LockstepServer::handle_input(Peer &peer, game::ByteReader &in)
+{
+    const std::uint64_t first = in.varint();
+    const int count = in.u8();
+    std::uint8_t buttons[256];
+    in.bytes(buttons, count);
+    const std::uint64_t command_ack = in.varint();
+    const game::Map::Revision snapshot_ack = in.varint();
+    if (!in.ok()) {
+        return;
+    }
+    // inputs are accepted in tick order only, a gap waits for the repetitions to fill it
+    PlayerInput &input = inputs_[peer.player];
+    for (int i=0; i<count; ++i) {
+        const std::uint64_t tick = first + i;
+        if (tick == input.received_until && tick < world_.tick() + input_window) {
+            input.buttons[tick % input_window] = buttons[i];
+            ++input.received_until;
+        }
+    }
+    peer.command_ack = std::max(peer.command_ack, command_ack);
+    // a client that failed to apply a snapshot asks for a complete one with 0
+    peer.snapshot_ack = snapshot_ack;
+}
+
+bool LockstepServer::inputs_ready(std::uint64_t tick) const
+{
+    for (const PlayerInput &input : inputs_) {
+        if (!input.local && input.received_until <= tick) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LockstepServer::step()
+{
+    const std::uint64_t tick = world_.tick();
+    for (Peer &peer : peers_) {
+        if (peer.joined) {
+            continue;
+        }
+        // the client sends its first buttons for tick + input_delay, it stands still until then
+        peer.player = world_.add_player();
+        peer.joined = true;
+        peer.join_tick = tick;
+        peer.command_ack = tick;
+        peer.snapshot_tick = tick - catch_up_interval;
+        PlayerInput input;
+        input.local = false;
+        input.local_buttons = 0;
+        input.buttons.assign(input_window, 0);
+        input.received_until = tick + options_.input_delay;
+        inputs_.push_back(input);
+        send_welcome(peer);
+    }
+
+    if (tick_handler_) {
+        tick_handler_(tick);
+    }
+    std::vector<std::uint8_t> &buttons = history_[tick % history_size];
+    buttons.resize(inputs_.size());
+    for (std::size_t player=0; player<inputs_.size(); ++player) {
+        PlayerInput &input = inputs_[player];
+        if (input.local) {
+            buttons[player] = input.local_buttons;
+            continue;
+        }
+        std::uint8_t &slot = input.buttons[tick % input_window];
+        if (input.received_until <= tick) {
+            // the player is too late, it keeps what it held and its input for this tick is dropped
+            slot = input.buttons[(tick + input_window - 1) % input_window];
+            input.received_until = tick + 1;
+        }
+        buttons[player] = slot;
+    }
+    for (std::size_t player=0; player<buttons.size(); ++player) {
+        world_.control(static_cast<int>(player), buttons[player]);
+    }
+    world_.update();
+    if (recorder_) {
+        recorder_->record(world_);
+    }
+
+    if (world_.tick() - history_begin_ > static_cast<std::uint64_t>(history_size)) {
+        ++history_begin_;
+    }
+}
+
+void LockstepServer::send_commands(const Peer &peer)
+{
+    const std::uint64_t first = std::max(peer.command_ack, history_begin_);
+    if (first >= world_.tick()) {
+        return;
+    }
+    const int count = static_cast<int>(std::min<std::uint64_t>(world_.tick() - first, max_redundant_ticks));
+    datagram_.clear();
+    game::ByteWriter out(datagram_);
+    writeHeader(out, Commands);
+    out.varint(first);
+    out.u8(count);
+    out.varint(inputs_[peer.player].received_until);
+    for (int i=0; i<count; ++i) {
+        const std::vector<std::uint8_t> &buttons = history_[(first + i) % history_size];
+        out.u8(buttons.size());
+        out.bytes(buttons.data(), buttons.size());
+    }
+    send(peer.address);
+}
+
+void LockstepServer::send_snapshot(Peer &peer)
+{
+    snapshot_.clear();
+    game::ByteWriter snapshot(snapshot_);
+    snapshot.varint(world_.map().revision());
+    world_.write_state(snapshot);
+    writeMapDelta(world_.map(), peer.snapshot_ack - 1, peer.snapshot_ack == 0, snapshot);
+    const std::size_t fragments = (snapshot_.size() + snapshot_fragment_size - 1) / snapshot_fragment_size;
+    if (fragments > static_cast<std::size_t>(max_snapshot_fragments)) {
+        std::cerr << "snapshot of " << snapshot_.size() << " bytes is too large to send\n";
+        return;
+    }
+    for (std::size_t i=0; i<fragments; ++i) {
+        const std::size_t offset = i * snapshot_fragment_size;
+        datagram_.clear();
+        game::ByteWriter out(datagram_);
+        writeHeader(out, Snapshot);
+        out.varint(world_.tick());
+        out.u8(i);
+        out.u8(fragments - 1);
+        out.bytes(snapshot_.data() + offset, std::min<std::size_t>(snapshot_fragment_size, snapshot_.size() - offset));
+        send(peer.address);
+    }
+    peer.snapshot_tick = world_.tick();
+}
+
+void LockstepServer::send_welcome(const Peer &peer)
+{
+    datagram_.clear();
+    game::ByteWriter out(datagram_);
+    writeHeader(out, Welcome);
+    out.varint(peer.player);
+    out.varint(peer.join_tick);
+    out.u8(options_.input_delay);
+    send(peer.address);
+}
+
+int LockstepServer::player_count() const
+{
+    // peers that asked to join get their player in the next step()
+    int joining = 0;
+    for (const Peer &peer : peers_) {
+        if (!peer.joined) {
+            ++joining;
+        }
+    }
+    return static_cast<int>(inputs_.size()) + joining;
+}
+
+void LockstepServer::send(const Address &to)
+{
+    if (socket_.send(to, datagram_.data(), datagram_.size())) {
+        bytes_sent_ += datagram_.size();
+    }
+}
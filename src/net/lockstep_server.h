@@ -0,0 +1,161 @@
+#ifndef LOCKSTEP_SERVER_H
+#define LOCKSTEP_SERVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <game/map.h>
+#include <game/replay.h>
+#include <game/world.h>
+
+#include "protocol.h"
+#include "udp_socket.h"
+
+namespace net {
+
+    /**
+     * @brief The LockstepOptions struct holds the timing of a lockstep match, in ticks
+     */
+    struct LockstepOptions {
+        int input_delay = 3;
+        int snapshot_interval = 60;
+        int max_stall_ticks = 15;
+    };
+
+    /**
+     * @brief The LockstepServer class runs the authoritative world of a networked match
+     *
+     * Clients send their buttons for tick t + input_delay while they simulate tick t. The
+     * server simulates a tick once the buttons of every player are known, and waits at most
+     * max_stall_ticks for a late player before repeating that player's previous buttons. The
+     * buttons of every simulated tick are sent to all clients, which run the same World, so a
+     * tick costs a few bytes per player regardless of the map size.
+     *
+     * Every snapshot_interval ticks each client also receives a snapshot with the entity state
+     * and the map chunks changed after the last snapshot that client acknowledged. Snapshots
+     * correct a client that diverged or missed commands, and bring joining clients up to date.
+     *
+     * A match has at most max_players, further join requests are ignored.
+     */
+    class LockstepServer
+    {
+    public:
+        /**
+         * @brief TickHandler is called with the number of each tick right before it is simulated
+         */
+        typedef std::function<void(std::uint64_t tick)> TickHandler;
+
+        explicit LockstepServer(game::World &world, LockstepOptions options = LockstepOptions());
+
+        LockstepServer(const LockstepServer&) = delete;
+        LockstepServer &operator=(const LockstepServer&) = delete;
+
+        /**
+         * @brief open starts accepting clients on a UDP port, 0 picks any free port
+         */
+        bool open(std::uint16_t port);
+        std::uint16_t port() const {
+            return socket_.local_port();
+        }
+
+        /**
+         * @brief add_local_player adds a player that is controlled on the server itself
+         * @return the index of the player in the world, -1 if the match has max_players
+         */
+        int add_local_player();
+        /**
+         * @brief set_local_input sets the buttons a local player holds from the next tick on
+         */
+        void set_local_input(int player, std::uint8_t buttons);
+
+        /**
+         * @brief set_recorder records every tick simulated from now on, nullptr stops recording
+         */
+        void set_recorder(game::ReplayRecorder *recorder) {
+            recorder_ = recorder;
+        }
+        /**
+         * @brief set_tick_handler lets local players decide their buttons for every simulated
+         * tick, also when update() simulates several ticks at once
+         */
+        void set_tick_handler(TickHandler handler) {
+            tick_handler_ = handler;
+        }
+
+        /**
+         * @brief update handles incoming messages, simulates due ticks and sends the results
+         * @param due_ticks the ticks that became due since the last call, see game::FixedStep
+         * @return the number of ticks simulated
+         */
+        int update(int due_ticks);
+
+        int client_count() const {
+            return static_cast<int>(peers_.size());
+        }
+        std::size_t bytes_sent() const {
+            return bytes_sent_;
+        }
+
+    private:
+        // the ticks of buttons kept per player, more than a client may send ahead
+        static const int input_window = 128;
+        // the ticks of commands kept for resending
+        static const int history_size = 2 * max_redundant_ticks;
+
+        struct PlayerInput {
+            bool local;
+            std::uint8_t local_buttons;
+            // buttons by tick modulo input_window, known for all ticks before received_until
+            std::vector<std::uint8_t> buttons;
+            std::uint64_t received_until;
+        };
+
+        struct Peer {
+            Address address;
+            int player;
+            bool joined;
+            std::uint64_t join_tick;
+            // the first tick whose commands the client lacks
+            std::uint64_t command_ack;
+            // the map revision of the last snapshot the client applied, plus one, 0 for none
+            game::Map::Revision snapshot_ack;
+            std::uint64_t snapshot_tick;
+        };
+
+        void receive();
+        void handle_input(Peer &peer, game::ByteReader &in);
+        bool inputs_ready(std::uint64_t tick) const;
+        void step();
+        void send_commands(const Peer &peer);
+        void send_snapshot(Peer &peer);
+        void send_welcome(const Peer &peer);
+        void send(const Address &to);
+        int player_count() const;
+
+        game::World &world_;
+        LockstepOptions options_;
+        UdpSocket socket_;
+        std::vector<PlayerInput> inputs_;
+        std::vector<Peer> peers_;
+
+        // the buttons of all players by tick modulo history_size, for the ticks from
+        // history_begin_ to the tick of the world, reused so that a tick does not allocate
+        std::vector<std::vector<std::uint8_t>> history_;
+        std::uint64_t history_begin_;
+
+        game::ReplayRecorder *recorder_;
+        TickHandler tick_handler_;
+        int budget_;
+        int stalled_;
+        std::size_t bytes_sent_;
+        std::vector<std::uint8_t> datagram_;
+        std::vector<std::uint8_t> packet_;
+        // the snapshot for one client before it is split into datagrams
+        std::vector<std::uint8_t> snapshot_;
+    };
+
+}
+
+#endif // LOCKSTEP_SERVER_H
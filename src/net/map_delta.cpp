@@ -0,0 +1,85 @@
+#include "map_delta.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace net;
+
+void net::writeMapDelta(const game::Map &map, game::Map::Revision base, bool full, game::ByteWriter &out)
+{
+    out.varint(map.row_count());
+    out.varint(map.col_count());
+    std::vector<int> chunks;
+    for (int chunk_row=0; chunk_row<map.chunk_row_count(); ++chunk_row) {
+        for (int chunk_col=0; chunk_col<map.chunk_col_count(); ++chunk_col) {
+            if (full || map.chunk_revision(chunk_row, chunk_col) > base) {
+                chunks.push_back(chunk_row * map.chunk_col_count() + chunk_col);
+            }
+        }
+    }
+    out.varint(chunks.size());
+    int previous = -1;
+    for (int chunk : chunks) {
+        // chunk indices are increasing, their gaps are smaller than the indices
+        out.varint(chunk - previous - 1);
+        previous = chunk;
+        const game::Map::ChunkBounds bounds = map.chunk_bounds(chunk / map.chunk_col_count(),
+                                                               chunk % map.chunk_col_count());
+        game::Map::CellType value = map.cell(bounds.row_begin, bounds.col_begin);
+        int run = 0;
+        for (int i=bounds.row_begin; i<bounds.row_end; ++i) {
+            for (int j=bounds.col_begin; j<bounds.col_end; ++j) {
+                if (map.cell(i, j) != value) {
+                    out.varint(run);
+                    out.u8(value);
+                    value = map.cell(i, j);
+                    run = 0;
+                }
+                ++run;
+            }
+        }
+        out.varint(run);
+        out.u8(value);
+    }
+}
+
+bool net::readMapDelta(game::ByteReader &in, game::Map &map)
+{
+    if (in.varint() != static_cast<std::uint64_t>(map.row_count())
+            || in.varint() != static_cast<std::uint64_t>(map.col_count())) {
+        return false;
+    }
+    const int chunk_count = map.chunk_row_count() * map.chunk_col_count();
+    const std::uint64_t count = in.varint();
+    std::int64_t chunk = -1;
+    for (std::uint64_t c=0; c<count && in.ok(); ++c) {
+        // the gap is checked before it is added, a huge one would overflow the chunk index
+        const std::uint64_t gap = in.varint();
+        if (gap >= static_cast<std::uint64_t>(chunk_count - 1 - chunk)) {
+            return false;
+        }
+        chunk += static_cast<std::int64_t>(gap) + 1;
+        const game::Map::ChunkBounds bounds = map.chunk_bounds(static_cast<int>(chunk) / map.chunk_col_count(),
+                                                               static_cast<int>(chunk) % map.chunk_col_count());
+        const int width = bounds.col_end - bounds.col_begin;
+        const int cells = width * (bounds.row_end - bounds.row_begin);
+        int cell = 0;
+        while (cell < cells && in.ok()) {
+            const std::uint64_t run = in.varint();
+            const game::Map::CellType value = static_cast<game::Map::CellType>(in.u8());
+            if (run == 0 || run > static_cast<std::uint64_t>(cells - cell)) {
+                return false;
+            }
+            // a run continues over the rows of the chunk, fill it row piece by row piece
+            for (int end=cell + static_cast<int>(run); cell<end; ) {
+                const int row = bounds.row_begin + cell / width;
+                const int col = cell % width;
+                const int length = std::min(width - col, end - cell);
+                game::Map::Rect piece = {row, bounds.col_begin + col, row + 1, bounds.col_begin + col + length};
+                map.fill(piece, value);
+                cell += length;
+            }
+        }
+    }
+    return in.ok();
+}
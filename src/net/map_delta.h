@@ -0,0 +1,30 @@
+#ifndef MAP_DELTA_H
+#define MAP_DELTA_H
+
+#include <game/byte_stream.h>
+#include <game/map.h>
+
+namespace net {
+
+    /**
+     * Map deltas carry the chunks of a map that changed after a base revision, found through
+     * the chunk revisions of game::Map without comparing cells. Each chunk is sent completely
+     * as runs of equal cells, so applying a delta does not depend on what the receiver had in
+     * that chunk before, only on it having every chunk that did not change since the base.
+     * A chunk with a single destroyed clay cell in an otherwise uniform area costs a few bytes.
+     */
+
+    /**
+     * @brief writeMapDelta writes the chunks of map modified after base, or all chunks if full
+     */
+    void writeMapDelta(const game::Map &map, game::Map::Revision base, bool full, game::ByteWriter &out);
+
+    /**
+     * @brief readMapDelta applies a delta to a map of the same size as the one it was made of
+     * @return false if the delta is invalid or for a map of a different size
+     */
+    bool readMapDelta(game::ByteReader &in, game::Map &map);
+
+}
+
+#endif // MAP_DELTA_H
@@ -0,0 +1,66 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+
+#include <game/byte_stream.h>
+
+namespace net {
+
+    /**
+     * Every datagram starts with protocol_id and a MessageType byte, the rest is
+     * little endian with varints for ticks, revisions and counts:
+     *
+     * Join      client to server, asks for a player
+     * Welcome   server to client: player, tick the player exists from, input delay
+     * Input     client to server: first tick, count, buttons for count ticks,
+     *           first tick whose commands the client lacks, last snapshot revision applied
+     * Commands  server to client: first tick, count, first tick the server lacks input of
+     *           this client for, then per tick the player count and the buttons of each player
+     * Snapshot  server to client: tick, fragment index, fragment count - 1, then the bytes of
+     *           that fragment of: map revision, world state, map delta
+     *
+     * Inputs and commands are repeated until acknowledged, so a lost datagram costs no round trip.
+     * A snapshot too large for one datagram is split into fragments of snapshot_fragment_size
+     * bytes, and is applied once all of them arrived. A lost fragment drops that snapshot, the
+     * client waits for the next one.
+     */
+    const std::uint8_t protocol_id = 0xBC;
+
+    enum MessageType : std::uint8_t {
+        Join = 1,
+        Welcome = 2,
+        Input = 3,
+        Commands = 4,
+        Snapshot = 5
+    };
+
+    // the most ticks a single Input or Commands message repeats
+    const int max_redundant_ticks = 32;
+    // the most players of a match, Commands messages count them in a byte
+    const int max_players = 255;
+    // the largest UDP payload, snapshots of big maps may need fragmentation by IP
+    const int max_datagram_size = 65507;
+    // the snapshot bytes of a datagram, leaving room for the header of the fragment
+    const int snapshot_fragment_size = max_datagram_size - 16;
+    // the most fragments of a snapshot, Snapshot messages count them in a byte
+    const int max_snapshot_fragments = 256;
+
+    inline void writeHeader(game::ByteWriter &out, MessageType type) {
+        out.u8(protocol_id);
+        out.u8(type);
+    }
+
+    /**
+     * @brief readHeader checks the protocol id and reads the message type
+     * @return false for datagrams of other protocols
+     */
+    inline bool readHeader(game::ByteReader &in, MessageType &type) {
+        const bool ours = in.u8() == protocol_id;
+        type = static_cast<MessageType>(in.u8());
+        return ours && in.ok();
+    }
+
+}
+
+#endif // PROTOCOL_H
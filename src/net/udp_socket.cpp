@@ -0,0 +1,177 @@
+#include "udp_socket.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace net;
+
+namespace {
+
+#ifdef _WIN32
+    const SOCKET invalid_handle = INVALID_SOCKET;
+
+    struct WinsockSession {
+        WinsockSession() {
+            WSADATA data;
+            WSAStartup(MAKEWORD(2, 2), &data);
+        }
+        ~WinsockSession() {
+            WSACleanup();
+        }
+    };
+
+    void startNetworking() {
+        static WinsockSession session;
+    }
+#else
+    const int invalid_handle = -1;
+
+    void startNetworking() {
+    }
+#endif
+
+    sockaddr_in toSockaddr(const Address &address) {
+        sockaddr_in result;
+        std::memset(&result, 0, sizeof(result));
+        result.sin_family = AF_INET;
+        result.sin_addr.s_addr = htonl(address.host);
+        result.sin_port = htons(address.port);
+        return result;
+    }
+
+}
+
+bool net::resolveAddress(const std::string &host, std::uint16_t port, Address &address)
+{
+    startNetworking();
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found) {
+        std::cerr << "could not resolve " << host << "\n";
+        return false;
+    }
+    address.host = ntohl(reinterpret_cast<sockaddr_in*>(found->ai_addr)->sin_addr.s_addr);
+    address.port = port;
+    freeaddrinfo(found);
+    return true;
+}
+
+UdpSocket::UdpSocket()
+    : handle_(invalid_handle)
+{
+}
+
+UdpSocket::~UdpSocket()
+{
+    close();
+}
+
+bool UdpSocket::open(std::uint16_t port)
+{
+    close();
+    startNetworking();
+    handle_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle_ == invalid_handle) {
+        std::cerr << "could not create a UDP socket\n";
+        return false;
+    }
+    Address any;
+    any.port = port;
+    sockaddr_in local = toSockaddr(any);
+    if (bind(handle_, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        std::cerr << "could not bind UDP port " << port << "\n";
+        close();
+        return false;
+    }
+    // a snapshot split into many datagrams arrives at once, the buffers are raised as far as
+    // the system allows so that it is not dropped before it is read, failing is not an error
+    const int buffer_size = 4 << 20;
+    setsockopt(handle_, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&buffer_size), sizeof(buffer_size));
+    setsockopt(handle_, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&buffer_size), sizeof(buffer_size));
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    const bool ok = ioctlsocket(handle_, FIONBIO, &nonblocking) == 0;
+#else
+    const bool ok = fcntl(handle_, F_SETFL, fcntl(handle_, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ok) {
+        std::cerr << "could not make the UDP socket nonblocking\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::close()
+{
+    if (handle_ == invalid_handle) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(handle_);
+#else
+    ::close(handle_);
+#endif
+    handle_ = invalid_handle;
+}
+
+bool UdpSocket::is_open() const
+{
+    return handle_ != invalid_handle;
+}
+
+std::uint16_t UdpSocket::local_port() const
+{
+    if (!is_open()) {
+        return 0;
+    }
+    sockaddr_in local;
+    socklen_t size = sizeof(local);
+    if (getsockname(handle_, reinterpret_cast<sockaddr*>(&local), &size) != 0) {
+        return 0;
+    }
+    return ntohs(local.sin_port);
+}
+
+bool UdpSocket::send(const Address &to, const std::uint8_t *data, std::size_t size)
+{
+    if (!is_open()) {
+        return false;
+    }
+    sockaddr_in target = toSockaddr(to);
+    return sendto(handle_, reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+                  reinterpret_cast<sockaddr*>(&target), sizeof(target)) == static_cast<int>(size);
+}
+
+int UdpSocket::receive(std::uint8_t *buffer, std::size_t capacity, Address &from)
+{
+    if (!is_open()) {
+        return -1;
+    }
+    sockaddr_in source;
+    socklen_t size = sizeof(source);
+    const int received = static_cast<int>(recvfrom(handle_, reinterpret_cast<char*>(buffer),
+                                                   static_cast<int>(capacity), 0,
+                                                   reinterpret_cast<sockaddr*>(&source), &size));
+    if (received < 0) {
+        return -1;
+    }
+    from.host = ntohl(source.sin_addr.s_addr);
+    from.port = ntohs(source.sin_port);
+    return received;
+}
@@ -0,0 +1,80 @@
+#ifndef UDP_SOCKET_H
+#define UDP_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace net {
+
+    /**
+     * @brief The Address struct is an IPv4 address and port in host byte order
+     */
+    struct Address {
+        std::uint32_t host = 0;
+        std::uint16_t port = 0;
+
+        bool operator==(const Address &other) const {
+            return host == other.host && port == other.port;
+        }
+        bool operator!=(const Address &other) const {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * @brief resolveAddress looks up a host name or dotted address
+     * @return false if the host is unknown
+     */
+    bool resolveAddress(const std::string &host, std::uint16_t port, Address &address);
+
+    /**
+     * @brief The UdpSocket class is a nonblocking UDP socket
+     *
+     * Lockstep traffic consists of small datagrams that are sent redundantly, a lost datagram
+     * is never retransmitted by itself, so nothing here waits or retries.
+     */
+    class UdpSocket {
+    public:
+        UdpSocket();
+        ~UdpSocket();
+
+        UdpSocket(const UdpSocket&) = delete;
+        UdpSocket &operator=(const UdpSocket&) = delete;
+
+        /**
+         * @brief open binds the socket to a local port, 0 picks any free port
+         * @return false if the socket could not be created or bound
+         */
+        bool open(std::uint16_t port = 0);
+        void close();
+
+        bool is_open() const;
+        /**
+         * @brief local_port is the port the socket is bound to, 0 if it is not open
+         */
+        std::uint16_t local_port() const;
+
+        /**
+         * @brief send sends one datagram
+         * @return false if the datagram could not be handed to the system
+         */
+        bool send(const Address &to, const std::uint8_t *data, std::size_t size);
+        /**
+         * @brief receive takes the next waiting datagram
+         * @return the size of the datagram, -1 if none is waiting
+         */
+        int receive(std::uint8_t *buffer, std::size_t capacity, Address &from);
+
+    private:
+#ifdef _WIN32
+        typedef std::uintptr_t Handle;
+#else
+        typedef int Handle;
+#endif
+        Handle handle_;
+    };
+
+}
+
+#endif // UDP_SOCKET_H
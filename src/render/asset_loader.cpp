@@ -0,0 +1,270 @@
+#include "asset_loader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+using namespace render;
+
+constexpr std::size_t AssetLoader::upload_band_bytes;
+
+namespace {
+
+bool readFile(const std::string &path, std::vector<char> &contents)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    const std::streamoff size = file.tellg();
+    file.seekg(0);
+    contents.resize(static_cast<std::size_t>(size));
+    return size == 0 || static_cast<bool>(file.read(contents.data(), size));
+}
+
+/**
+ * @brief readHeader splits a Netpbm header into tokens up to and including the last one
+ * it needs, skipping comments
+ * @return the offset right after the single whitespace ending the header, or 0 on errors
+ */
+std::size_t readHeader(const std::vector<char> &bytes, bool pam, std::vector<std::string> &tokens)
+{
+    std::size_t i = 0;
+    while (i < bytes.size()) {
+        const char c = bytes[i];
+        if (c == '#') {
+            while (i < bytes.size() && bytes[i] != '\n') {
+                ++i;
+            }
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else {
+            const std::size_t begin = i;
+            while (i < bytes.size() && !std::isspace(static_cast<unsigned char>(bytes[i]))) {
+                ++i;
+            }
+            tokens.push_back(std::string(bytes.data() + begin, i - begin));
+            const bool done = pam ? tokens.back() == "ENDHDR" : tokens.size() == 4;
+            if (done) {
+                return i < bytes.size() ? i + 1 : 0;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief decodeNetpbm converts a binary PPM or PAM image with a maximum value of 255 to RGBA
+ */
+bool decodeNetpbm(const std::vector<char> &bytes, int &width, int &height, std::vector<std::uint8_t> &rgba)
+{
+    if (bytes.size() < 2 || bytes[0] != 'P' || (bytes[1] != '6' && bytes[1] != '7')) {
+        return false;
+    }
+    const bool pam = bytes[1] == '7';
+    std::vector<std::string> tokens;
+    const std::size_t offset = readHeader(bytes, pam, tokens);
+    if (offset == 0) {
+        return false;
+    }
+    int depth = 3;
+    int max_value = 0;
+    width = 0;
+    height = 0;
+    if (pam) {
+        for (std::size_t i=1; i + 1<tokens.size(); ++i) {
+            if (tokens[i] == "WIDTH") {
+                width = std::atoi(tokens[i + 1].c_str());
+            } else if (tokens[i] == "HEIGHT") {
+                height = std::atoi(tokens[i + 1].c_str());
+            } else if (tokens[i] == "DEPTH") {
+                depth = std::atoi(tokens[i + 1].c_str());
+            } else if (tokens[i] == "MAXVAL") {
+                max_value = std::atoi(tokens[i + 1].c_str());
+            }
+        }
+    } else {
+        width = std::atoi(tokens[1].c_str());
+        height = std::atoi(tokens[2].c_str());
+        max_value = std::atoi(tokens[3].c_str());
+    }
+    if (width <= 0 || height <= 0 || max_value != 255 || (depth != 3 && depth != 4)) {
+        return false;
+    }
+    const std::size_t pixel_count = static_cast<std::size_t>(width) * height;
+    if (bytes.size() - offset < pixel_count * depth) {
+        return false;
+    }
+    rgba.resize(pixel_count * 4);
+    const std::uint8_t *source = reinterpret_cast<const std::uint8_t*>(bytes.data() + offset);
+    for (std::size_t i=0; i<pixel_count; ++i) {
+        rgba[i * 4] = source[i * depth];
+        rgba[i * 4 + 1] = source[i * depth + 1];
+        rgba[i * 4 + 2] = source[i * depth + 2];
+        rgba[i * 4 + 3] = depth == 4 ? source[i * depth + 3] : 255;
+    }
+    return true;
+}
+
+}
+
+AssetLoader::AssetLoader(int thread_count)
+    : pending_(0),
+      pbo_(0),
+      workers_(thread_count)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    // workers only touch the completion queue, which outlives them, see the header
+    if (current_ && current_->texture != 0) {
+        glDeleteTextures(1, &current_->texture);
+    }
+    if (pbo_ != 0) {
+        glDeleteBuffers(1, &pbo_);
+    }
+}
+
+void AssetLoader::complete(std::unique_ptr<Result> result)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    completed_.push_back(std::move(result));
+}
+
+void AssetLoader::load_level(const std::string &path, LevelHandler done)
+{
+    ++pending_;
+    workers_.submit([this, path, done] {
+        std::shared_ptr<game::Map> level(game::Map::load(path).release());
+        if (level) {
+            // touch every page of the mapping, such that the GL thread does not fault them in
+            volatile std::uint8_t sum = 0;
+            const std::uint8_t *cells = reinterpret_cast<const std::uint8_t*>(level->data());
+            for (int i=0; i<level->cell_count(); i+=4096) {
+                sum += cells[i];
+            }
+        }
+        std::unique_ptr<Result> result(new Result());
+        result->deliver = [done, level] {
+            done(level ? std::unique_ptr<game::Map>(new game::Map(std::move(*level))) : nullptr);
+        };
+        complete(std::move(result));
+    });
+}
+
+void AssetLoader::load_file(const std::string &path, FileHandler done)
+{
+    ++pending_;
+    workers_.submit([this, path, done] {
+        std::shared_ptr<std::vector<char>> contents = std::make_shared<std::vector<char>>();
+        const bool ok = readFile(path, *contents);
+        std::unique_ptr<Result> result(new Result());
+        result->deliver = [done, ok, contents] {
+            done(ok, std::move(*contents));
+        };
+        complete(std::move(result));
+    });
+}
+
+void AssetLoader::load_texture(const std::string &path, TextureHandler done)
+{
+    ++pending_;
+    workers_.submit([this, path, done] {
+        std::unique_ptr<Result> result(new Result());
+        result->texture_done = done;
+        std::vector<char> bytes;
+        if (!readFile(path, bytes) || !decodeNetpbm(bytes, result->width, result->height, result->pixels)) {
+            std::cerr << "could not load texture " << path << "\n";
+            result->width = 0;
+            result->height = 0;
+            result->pixels.clear();
+        }
+        complete(std::move(result));
+    });
+}
+
+bool AssetLoader::upload_step(Result &result)
+{
+    if (result.pixels.empty()) {
+        result.texture_done(0, 0, 0);
+        return true;
+    }
+    if (result.texture == 0) {
+        glGenTextures(1, &result.texture);
+        glBindTexture(GL_TEXTURE_2D, result.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, result.width, result.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (pbo_ == 0) {
+            glGenBuffers(1, &pbo_);
+        }
+    }
+
+    const std::size_t row_bytes = static_cast<std::size_t>(result.width) * 4;
+    const int rows = std::min(std::max(static_cast<int>(upload_band_bytes / row_bytes), 1),
+                              result.height - result.uploaded_rows);
+    const std::size_t band_bytes = row_bytes * rows;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_);
+    // orphan the buffer, such that the driver does not wait for the previous band
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, band_bytes, nullptr, GL_STREAM_DRAW);
+    void *staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, band_bytes,
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (staging != nullptr) {
+        std::memcpy(staging, result.pixels.data() + row_bytes * result.uploaded_rows, band_bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glBindTexture(GL_TEXTURE_2D, result.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (staging != nullptr) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, result.uploaded_rows, result.width, rows,
+                        GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (staging == nullptr) {
+        // mapping can fail on a lost context, upload the band directly instead
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, result.uploaded_rows, result.width, rows,
+                        GL_RGBA, GL_UNSIGNED_BYTE, result.pixels.data() + row_bytes * result.uploaded_rows);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    result.uploaded_rows += rows;
+    if (result.uploaded_rows < result.height) {
+        return false;
+    }
+    const GLuint texture = result.texture;
+    result.texture = 0;
+    result.texture_done(texture, result.width, result.height);
+    return true;
+}
+
+void AssetLoader::update(double budget_seconds)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+    do {
+        if (!current_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (completed_.empty()) {
+                return;
+            }
+            current_ = std::move(completed_.front());
+            completed_.pop_front();
+        }
+        if (current_->deliver) {
+            current_->deliver();
+        } else if (!upload_step(*current_)) {
+            continue;
+        }
+        current_.reset();
+        --pending_;
+    } while (std::chrono::duration<double>(Clock::now() - start).count() < budget_seconds);
+}
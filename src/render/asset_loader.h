@@ -0,0 +1,115 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <game/map.h>
+#include <game/worker_pool.h>
+
+namespace render {
+
+    /**
+     * @brief The AssetLoader class reads and decodes asset files on worker threads and
+     * finishes them on the GL thread without stalling the frame
+     *
+     * The load functions only queue a job and return. Workers read the file, decode it and
+     * hand the result back; update(), called once per frame on the GL thread, then delivers
+     * the results to their handlers in the order they completed, but stops as soon as the
+     * given time budget is used up and continues in the next frame. Textures are uploaded
+     * in bands of rows through a pixel buffer object, so even a large image only costs a
+     * slice of a frame at a time.
+     *
+     * Handlers run on the GL thread inside update(). A loader must be created and destroyed
+     * with the GL context current; results that were not delivered are dropped.
+     */
+    class AssetLoader
+    {
+    public:
+        /**
+         * @brief LevelHandler receives the loaded level, or nullptr if it could not be loaded
+         */
+        typedef std::function<void(std::unique_ptr<game::Map>)> LevelHandler;
+        /**
+         * @brief TextureHandler receives an RGBA8 texture owned by the handler from then on,
+         * or 0 if the image could not be loaded
+         */
+        typedef std::function<void(GLuint texture, int width, int height)> TextureHandler;
+        /**
+         * @brief FileHandler receives the contents of a file, ok is false if it could not be read
+         */
+        typedef std::function<void(bool ok, std::vector<char> contents)> FileHandler;
+
+        explicit AssetLoader(int thread_count = std::min(game::WorkerPool::default_thread_count(), 4));
+        ~AssetLoader();
+
+        AssetLoader(const AssetLoader &) = delete;
+        AssetLoader &operator=(const AssetLoader &) = delete;
+
+        /**
+         * @brief load_level maps a binary level file, see game::Map::load()
+         */
+        void load_level(const std::string &path, LevelHandler done);
+
+        /**
+         * @brief load_texture decodes a binary PPM (P6) or PAM (P7) image with 8 bit channels
+         */
+        void load_texture(const std::string &path, TextureHandler done);
+
+        void load_file(const std::string &path, FileHandler done);
+
+        /**
+         * @brief update delivers finished assets for at most budget_seconds
+         *
+         * At least one step of work is done per call, so loading always makes progress.
+         */
+        void update(double budget_seconds);
+
+        /**
+         * @brief pending counts the assets that were requested but not delivered yet
+         */
+        int pending() const {
+            return pending_;
+        }
+
+    private:
+        // the staging size of a texture upload step
+        static constexpr std::size_t upload_band_bytes = 1 << 20;
+
+        struct Result {
+            // delivers a level or a file, empty for textures
+            std::function<void()> deliver;
+
+            TextureHandler texture_done;
+            int width = 0;
+            int height = 0;
+            std::vector<std::uint8_t> pixels;
+            GLuint texture = 0;
+            int uploaded_rows = 0;
+        };
+
+        void complete(std::unique_ptr<Result> result);
+        bool upload_step(Result &result);
+
+        std::mutex mutex_;
+        std::deque<std::unique_ptr<Result>> completed_;
+        std::unique_ptr<Result> current_;
+        std::atomic<int> pending_;
+        GLuint pbo_;
+        // declared last, such that the workers are joined before the queue goes away
+        game::WorkerPool workers_;
+    };
+
+}
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,46 @@
+#include "entity_renderer.h"
+
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace render;
+
+EntityRenderer::EntityRenderer()
+    : atlas_(256, 256),
+      sheet_(buildSpriteSheet(atlas_))
+{
+}
+
+void EntityRenderer::submit(RenderQueue &queue, const glm::mat4x4 &ortho, const game::Map &map,
+                            const game::EntityStore &tanks, const game::EntityStore &bullets,
+                            const game::EntityStore &pickups, float alpha, int layer)
+{
+    float scaleFactor = 1.0f / std::max(map.row_count(), 1);
+    glm::mat4 gridScale = glm::scale(glm::mat4(1.0f), glm::vec3(scaleFactor, scaleFactor, scaleFactor));
+    batch_.begin(ortho * gridScale);
+    add_sprites(map, pickups, sheet_.pickup, 1.0f, Layer::PickupLayer, alpha);
+    add_sprites(map, tanks, sheet_.tank, 1.0f, Layer::TankLayer, alpha);
+    add_sprites(map, bullets, sheet_.bullet, 0.25f, Layer::BulletLayer, alpha);
+    batch_.end(queue, layer);
+}
+
+void EntityRenderer::add_sprites(const game::Map &map, const game::EntityStore &entities, int region, float size,
+                                 Layer layer, float alpha)
+{
+    const float *x = entities.x();
+    const float *y = entities.y();
+    const float *previous_x = entities.previous_x();
+    const float *previous_y = entities.previous_y();
+    const game::Direction *direction = entities.direction();
+    for (int i=0; i<entities.size(); ++i) {
+        const float center_x = previous_x[i] + (x[i] - previous_x[i]) * alpha;
+        const float center_y = previous_y[i] + (y[i] - previous_y[i]) * alpha;
+        // cell units to the map's world units, where a cell is two units wide
+        const float left = 2 * (center_x - size / 2) - map.col_count();
+        const float bottom = 2 * (center_y - size / 2) - map.row_count();
+        // sprites point up, every direction step is a clockwise quarter turn
+        const int quarter_turns = (4 - direction[i]) % 4;
+        batch_.draw(atlas_, region, left, bottom, 2 * size, 2 * size, quarter_turns, layer);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef ENTITY_RENDERER_H
+#define ENTITY_RENDERER_H
+
+#include <glm/glm.hpp>
+
+#include <game/entities.h>
+#include <game/map.h>
+
+#include "sprite_batch.h"
+#include "sprites.h"
+#include "texture_atlas.h"
+
+namespace render {
+
+    /**
+     * @brief The EntityRenderer class draws tanks, bullets and pickups on top of a map
+     *
+     * All entities go through one SpriteBatch with the built-in sprite sheet, so a frame
+     * costs one draw call per entity layer. Positions are interpolated between the previous
+     * and the current tick by alpha, see game::FixedStep::alpha().
+     */
+    class EntityRenderer
+    {
+    public:
+        EntityRenderer();
+
+        /**
+         * @brief submit queues the entities in the same coordinate system as MapRenderer
+         * @param ortho the projection the map is rendered with
+         * @param map the map the entities are on
+         * @param alpha 0 draws the entities at their previous position, 1 at the current one
+         * @param layer the queue layer of pickups, tanks and bullets take the layers above it
+         */
+        void submit(RenderQueue &queue, const glm::mat4x4 &ortho, const game::Map &map,
+                    const game::EntityStore &tanks, const game::EntityStore &bullets,
+                    const game::EntityStore &pickups, float alpha, int layer);
+
+        int draw_calls() const {
+            return batch_.draw_calls();
+        }
+    private:
+        enum Layer {
+            PickupLayer,
+            TankLayer,
+            BulletLayer
+        };
+
+        void add_sprites(const game::Map &map, const game::EntityStore &entities, int region, float size,
+                         Layer layer, float alpha);
+
+        TextureAtlas atlas_;
+        SpriteSheet sheet_;
+        SpriteBatch batch_;
+    };
+
+}
+
+#endif // ENTITY_RENDERER_H
@@ -0,0 +1,77 @@
+#include "gl_state_cache.h"
+
+using namespace render;
+
+GlStateCache::GlStateCache()
+    : changes_(0),
+      skipped_(0)
+{
+    invalidate();
+}
+
+void GlStateCache::invalidate()
+{
+    program_ = unknown;
+    vao_ = unknown;
+    texture_ = unknown;
+    blend_ = unknown;
+}
+
+void GlStateCache::use_program(GLuint program)
+{
+    if (program_ == program) {
+        ++skipped_;
+        return;
+    }
+    glUseProgram(program);
+    program_ = program;
+    ++changes_;
+}
+
+void GlStateCache::bind_vertex_array(GLuint vao)
+{
+    if (vao_ == vao) {
+        ++skipped_;
+        return;
+    }
+    glBindVertexArray(vao);
+    vao_ = vao;
+    ++changes_;
+}
+
+void GlStateCache::bind_texture(GLuint texture)
+{
+    if (texture_ == texture) {
+        ++skipped_;
+        return;
+    }
+    if (texture_ == unknown) {
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    texture_ = texture;
+    ++changes_;
+}
+
+void GlStateCache::set_blend(bool enabled)
+{
+    const GLuint blend = enabled ? 1 : 0;
+    if (blend_ == blend) {
+        ++skipped_;
+        return;
+    }
+    if (enabled) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    blend_ = blend;
+    ++changes_;
+}
+
+void GlStateCache::reset_counters()
+{
+    changes_ = 0;
+    skipped_ = 0;
+}
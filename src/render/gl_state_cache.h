@@ -0,0 +1,62 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace render {
+
+    /**
+     * @brief The GlStateCache class remembers the bindings it made and skips repeating them
+     *
+     * Only GL calls made through the cache are known to it. Code that binds directly leaves
+     * the cache stale, invalidate() then makes it forget everything, so the next request of
+     * every binding reaches the driver again.
+     */
+    class GlStateCache
+    {
+    public:
+        GlStateCache();
+
+        void invalidate();
+
+        void use_program(GLuint program);
+        void bind_vertex_array(GLuint vao);
+        /**
+         * @brief bind_texture binds a 2D texture to texture unit 0
+         */
+        void bind_texture(GLuint texture);
+        /**
+         * @brief set_blend switches alpha blending with GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+         */
+        void set_blend(bool enabled);
+
+        /**
+         * @brief changes counts the calls that reached the driver since reset_counters()
+         */
+        int changes() const {
+            return changes_;
+        }
+        /**
+         * @brief skipped counts the calls that were redundant since reset_counters()
+         */
+        int skipped() const {
+            return skipped_;
+        }
+        void reset_counters();
+
+    private:
+        // a value no object name takes, used for state the cache does not know
+        static const GLuint unknown = 0xffffffffu;
+
+        GLuint program_;
+        GLuint vao_;
+        GLuint texture_;
+        GLuint blend_;
+        int changes_;
+        int skipped_;
+    };
+
+}
+
+#endif // GL_STATE_CACHE_H
@@ -0,0 +1,606 @@
+#include "map_renderer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace render;
+
+namespace {
+
+// Shaders
+const GLchar* vertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "layout (location = 1) in vec2 cellOffset;\n"
+    "layout (location = 2) in uint cellType;\n"
+    "uniform mat4 viewMatrix;\n"
+    "flat out uint fragCellType;\n"
+    "void main()\n"
+    "{\n"
+    "gl_Position = viewMatrix * vec4(position + vec3(cellOffset, 0.0), 1.0);\n"
+    "fragCellType = cellType;\n"
+    "}\0";
+const GLchar* fragmentShaderSource = "#version 330 core\n"
+    "flat in uint fragCellType;\n"
+    "out vec4 color;\n"
+    "const vec4 palette[5] = vec4[5](\n"
+    "    vec4(0.0f, 1.0f, 0.0f, 1.0f),\n"   // Floor
+    "    vec4(0.7f, 0.4f, 0.2f, 1.0f),\n"   // Clay
+    "    vec4(0.6f, 0.6f, 0.6f, 1.0f),\n"   // Wall
+    "    vec4(0.3f, 0.3f, 0.3f, 1.0f),\n"   // Rock
+    "    vec4(0.1f, 0.3f, 0.9f, 1.0f));\n"  // Water
+    "void main()\n"
+    "{\n"
+    "color = fragCellType < 5u ? palette[fragCellType] : vec4(1.0f, 0.0f, 1.0f, 1.0f);\n"
+    "}\n\0";
+// The chunked strategy has no offset array, cells are laid out by instance id row by row
+const GLchar* chunkVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec3 position;\n"
+    "layout (location = 2) in uint cellType;\n"
+    "uniform mat4 viewMatrix;\n"
+    "uniform vec2 chunkOrigin;\n"
+    "uniform int chunkWidth;\n"
+    "flat out uint fragCellType;\n"
+    "void main()\n"
+    "{\n"
+    "vec2 cellOffset = chunkOrigin + 2.0 * vec2(gl_InstanceID % chunkWidth, gl_InstanceID / chunkWidth);\n"
+    "gl_Position = viewMatrix * vec4(position + vec3(cellOffset, 0.0), 1.0);\n"
+    "fragCellType = cellType;\n"
+    "}\0";
+// The baked strategy has every corner of every cell in its vertex buffer
+const GLchar* bakedVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec2 position;\n"
+    "layout (location = 2) in uint cellType;\n"
+    "uniform mat4 viewMatrix;\n"
+    "flat out uint fragCellType;\n"
+    "void main()\n"
+    "{\n"
+    "gl_Position = viewMatrix * vec4(position, 0.0, 1.0);\n"
+    "fragCellType = cellType;\n"
+    "}\0";
+// The tilemap strategy draws one quad over the whole map, its corners come from the vertex id
+const GLchar* tilemapVertexShaderSource = "#version 330 core\n"
+    "uniform mat4 viewMatrix;\n"
+    "uniform vec2 mapSize;\n"
+    "out vec2 cellPosition;\n"
+    "void main()\n"
+    "{\n"
+    "cellPosition = mapSize * vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+    "gl_Position = viewMatrix * vec4(2.0 * cellPosition - mapSize, 0.0, 1.0);\n"
+    "}\0";
+const GLchar* tilemapFragmentShaderSource = "#version 330 core\n"
+    "in vec2 cellPosition;\n"
+    "uniform usampler2D cells;\n"
+    "uniform vec2 mapSize;\n"
+    "out vec4 color;\n"
+    "const vec4 palette[5] = vec4[5](\n"
+    "    vec4(0.0f, 1.0f, 0.0f, 1.0f),\n"   // Floor
+    "    vec4(0.7f, 0.4f, 0.2f, 1.0f),\n"   // Clay
+    "    vec4(0.6f, 0.6f, 0.6f, 1.0f),\n"   // Wall
+    "    vec4(0.3f, 0.3f, 0.3f, 1.0f),\n"   // Rock
+    "    vec4(0.1f, 0.3f, 0.9f, 1.0f));\n"  // Water
+    "void main()\n"
+    "{\n"
+    "ivec2 cell = clamp(ivec2(cellPosition), ivec2(0), ivec2(mapSize) - 1);\n"
+    "uint cellType = texelFetch(cells, cell, 0).r;\n"
+    "color = cellType < 5u ? palette[cellType] : vec4(1.0f, 0.0f, 1.0f, 1.0f);\n"
+    "}\n\0";
+
+}
+
+
+const char *MapRenderer::mode_name(Mode mode)
+{
+    switch (mode) {
+    case Mode::PerCell:
+        return "per-cell";
+    case Mode::Instanced:
+        return "instanced";
+    case Mode::Chunked:
+        return "chunked";
+    case Mode::Tilemap:
+        return "tilemap";
+    case Mode::Baked:
+        return "baked";
+    default:
+        return "unknown";
+    }
+}
+
+game::ResourceCounter MapRenderer::buffers("gl.map_buffers");
+game::ResourceCounter MapRenderer::textures("gl.map_textures");
+game::ResourceCounter MapRenderer::vertex_arrays("gl.map_vertex_arrays");
+
+float MapRenderer::aspect_ratio(const game::Map &map)
+{
+    if (map.row_count() == 0 || map.col_count() == 0) {
+        return 1.0f;
+    }
+    return static_cast<float>(map.col_count()) / map.row_count();
+}
+
+MapRenderer::MapRenderer(const game::Map &map, glm::mat4x4 &ortho, Mode mode)
+    : program_(ProgramCache::shared().get(vertexShaderSource, fragmentShaderSource)),
+      ortho_(ortho),
+      mode_(mode),
+      draw_calls_(0),
+      map_(&map),
+      revision_(map.revision())
+{
+    glGenVertexArrays(1, &cellVao_);
+    glGenBuffers(1, &cellVbo_);
+    glBindVertexArray(cellVao_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cellVbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    track_vertex_array();
+    track_buffer(sizeof(vertices));
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindVertexArray(0);
+
+    viewMatrixLocation_ = program_->uniform_location("viewMatrix");
+    float scaleFactor = 1.0f / std::max(map_->row_count(), 1);
+    gridScale_ = glm::scale(glm::mat4(1.0f), glm::vec3(scaleFactor, scaleFactor, scaleFactor));
+
+    switch (mode_) {
+    case Mode::PerCell:
+        break;
+    case Mode::Instanced:
+        init_instancing();
+        break;
+    case Mode::Chunked:
+        init_chunks();
+        break;
+    case Mode::Tilemap:
+        if (!init_tilemap()) {
+            mode_ = Mode::Instanced;
+            init_instancing();
+        }
+        break;
+    case Mode::Baked:
+        init_baked();
+        break;
+    }
+}
+
+MapRenderer::~MapRenderer()
+{
+    for (const Chunk &chunk : chunks_) {
+        glDeleteVertexArrays(1, &chunk.vao);
+        glDeleteBuffers(1, &chunk.cellTypeVbo);
+    }
+    glDeleteVertexArrays(1, &bakedVao_);
+    glDeleteBuffers(1, &bakedIbo_);
+    glDeleteBuffers(1, &bakedVbo_);
+    glDeleteVertexArrays(1, &tilemapVao_);
+    glDeleteTextures(1, &cellTexture_);
+    glDeleteVertexArrays(1, &instanceVao_);
+    glDeleteBuffers(1, &cellTypeVbo_);
+    glDeleteBuffers(1, &offsetVbo_);
+    glDeleteVertexArrays(1, &cellVao_);
+    glDeleteBuffers(1, &cellVbo_);
+    buffers.release(buffer_bytes_, buffer_count_);
+    textures.release(texture_bytes_, texture_count_);
+    vertex_arrays.release(0, vertex_array_count_);
+}
+
+void MapRenderer::track_buffer(std::size_t bytes)
+{
+    buffers.acquire(bytes);
+    buffer_bytes_ += bytes;
+    ++buffer_count_;
+}
+
+void MapRenderer::track_texture(std::size_t bytes)
+{
+    textures.acquire(bytes);
+    texture_bytes_ += bytes;
+    ++texture_count_;
+}
+
+void MapRenderer::track_vertex_array()
+{
+    vertex_arrays.acquire(0);
+    ++vertex_array_count_;
+}
+
+void MapRenderer::observe(const game::Map &map)
+{
+    assert(map.row_count() == map_->row_count() && map.col_count() == map_->col_count());
+    map_ = &map;
+}
+
+void MapRenderer::submit(RenderQueue &queue, int layer)
+{
+    switch (mode_) {
+    case Mode::PerCell:
+        submit_per_cell(queue, layer);
+        break;
+    case Mode::Instanced:
+        submit_instanced(queue, layer);
+        break;
+    case Mode::Chunked:
+        submit_chunked(queue, layer);
+        break;
+    case Mode::Tilemap:
+        submit_tilemap(queue, layer);
+        break;
+    case Mode::Baked:
+        submit_baked(queue, layer);
+        break;
+    }
+}
+
+void MapRenderer::init_instancing()
+{
+    std::vector<GLfloat> offsets;
+    offsets.reserve(2 * map_->row_count() * map_->col_count());
+    for (int i=0; i<map_->row_count(); ++i) {
+        for (int j=0; j<map_->col_count(); ++j) {
+            offsets.push_back((j - (map_->col_count()-1)/2.0f)*2);
+            offsets.push_back((i - (map_->row_count()-1)/2.0f)*2);
+        }
+    }
+
+    glGenVertexArrays(1, &instanceVao_);
+    glGenBuffers(1, &offsetVbo_);
+    glGenBuffers(1, &cellTypeVbo_);
+    glBindVertexArray(instanceVao_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, cellVbo_);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, offsetVbo_);
+    glBufferData(GL_ARRAY_BUFFER, offsets.size() * sizeof(GLfloat), offsets.data(), GL_STATIC_DRAW);
+    track_vertex_array();
+    track_buffer(offsets.size() * sizeof(GLfloat));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    static_assert(sizeof(game::Map::CellType) == sizeof(GLubyte), "cells are uploaded as bytes");
+    glBindBuffer(GL_ARRAY_BUFFER, cellTypeVbo_);
+    glBufferData(GL_ARRAY_BUFFER, map_->cell_count(), map_->data(), GL_DYNAMIC_DRAW);
+    track_buffer(map_->cell_count());
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_BYTE, sizeof(GLubyte), (GLvoid*)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    revision_ = map_->revision();
+
+    glBindVertexArray(0);
+}
+
+void MapRenderer::sync_cell_types()
+{
+    if (revision_ == map_->revision()) {
+        return;
+    }
+    const int chunk_size = game::Map::chunk_size;
+    if (mode_ == Mode::Tilemap) {
+        glBindTexture(GL_TEXTURE_2D, cellTexture_);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, cellTypeVbo_);
+    }
+    for (int chunk_row=0; chunk_row<map_->chunk_row_count(); ++chunk_row) {
+        int chunk_col = 0;
+        while (chunk_col < map_->chunk_col_count()) {
+            if (map_->chunk_revision(chunk_row, chunk_col) <= revision_) {
+                ++chunk_col;
+                continue;
+            }
+            int first_chunk_col = chunk_col;
+            while (chunk_col < map_->chunk_col_count() && map_->chunk_revision(chunk_row, chunk_col) > revision_) {
+                ++chunk_col;
+            }
+            upload_cell_types(chunk_row * chunk_size,
+                              first_chunk_col * chunk_size,
+                              std::min((chunk_row + 1) * chunk_size, map_->row_count()),
+                              std::min(chunk_col * chunk_size, map_->col_count()));
+        }
+    }
+    revision_ = map_->revision();
+}
+
+void MapRenderer::upload_cell_types(int row_begin, int col_begin, int row_end, int col_end)
+{
+    const int cols = map_->col_count();
+    if (mode_ == Mode::Tilemap) {
+        // the unpack row length lets the texture read the rectangle straight from the map
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, cols);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, col_begin, row_begin, col_end - col_begin, row_end - row_begin,
+                        GL_RED_INTEGER, GL_UNSIGNED_BYTE, map_->data() + row_begin * cols + col_begin);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return;
+    }
+    if (col_begin == 0 && col_end == cols) {
+        glBufferSubData(GL_ARRAY_BUFFER, row_begin * cols, (row_end - row_begin) * cols,
+                        map_->data() + row_begin * cols);
+        return;
+    }
+    for (int i=row_begin; i<row_end; ++i) {
+        glBufferSubData(GL_ARRAY_BUFFER, i * cols + col_begin, col_end - col_begin,
+                        map_->data() + i * cols + col_begin);
+    }
+}
+
+void MapRenderer::submit_per_cell(RenderQueue &queue, int layer)
+{
+    // cellVao_ has no offset or cell type arrays, the whole translation goes into the
+    // view matrix and the cell type is set as a constant attribute per draw, the constant
+    // offset is the same for all of them and is no vertex array state
+    glVertexAttrib2f(1, 0.0f, 0.0f);
+    const glm::mat4 gridView = ortho_ * gridScale_;
+    for (int i=0; i<map_->row_count(); ++i) {
+        for (int j=0; j<map_->col_count(); ++j) {
+            glm::mat4 cellTranslate = glm::translate(glm::mat4(1.0f),
+                                                     glm::vec3((j - (map_->col_count()-1)/2.0)*2,
+                                                               (i - (map_->row_count()-1)/2.0)*2,
+                                                               0));
+            queue.add(layer, program_->gl_ref(), cellVao_, 0, false, DrawCall::arrays(GL_TRIANGLES, 0, 6));
+            queue.set_uniform(viewMatrixLocation_, gridView * cellTranslate);
+            queue.set_attribute(2, map_->cell(i, j));
+        }
+    }
+    draw_calls_ = map_->cell_count();
+}
+
+void MapRenderer::submit_instanced(RenderQueue &queue, int layer)
+{
+    sync_cell_types();
+    queue.add(layer, program_->gl_ref(), instanceVao_, 0, false,
+              DrawCall::arrays(GL_TRIANGLES, 0, 6, map_->row_count() * map_->col_count()));
+    queue.set_uniform(viewMatrixLocation_, ortho_ * gridScale_);
+    draw_calls_ = 1;
+}
+
+void MapRenderer::init_chunks()
+{
+    chunkProgram_ = ProgramCache::shared().get(chunkVertexShaderSource, fragmentShaderSource);
+    chunkViewMatrixLocation_ = chunkProgram_->uniform_location("viewMatrix");
+    chunkOriginLocation_ = chunkProgram_->uniform_location("chunkOrigin");
+    chunkWidthLocation_ = chunkProgram_->uniform_location("chunkWidth");
+
+    chunk_staging_.resize(game::Map::chunk_size * game::Map::chunk_size);
+    chunks_.resize(map_->chunk_row_count() * map_->chunk_col_count());
+    for (int chunk_row=0; chunk_row<map_->chunk_row_count(); ++chunk_row) {
+        for (int chunk_col=0; chunk_col<map_->chunk_col_count(); ++chunk_col) {
+            Chunk &chunk = chunks_[chunk_row * map_->chunk_col_count() + chunk_col];
+            chunk.bounds = map_->chunk_bounds(chunk_row, chunk_col);
+            chunk.origin = glm::vec2((chunk.bounds.col_begin - (map_->col_count()-1)/2.0f)*2,
+                                     (chunk.bounds.row_begin - (map_->row_count()-1)/2.0f)*2);
+
+            glGenVertexArrays(1, &chunk.vao);
+            glGenBuffers(1, &chunk.cellTypeVbo);
+            glBindVertexArray(chunk.vao);
+
+            glBindBuffer(GL_ARRAY_BUFFER, cellVbo_);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+            glEnableVertexAttribArray(0);
+
+            const int cell_count = (chunk.bounds.row_end - chunk.bounds.row_begin)
+                    * (chunk.bounds.col_end - chunk.bounds.col_begin);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.cellTypeVbo);
+            glBufferData(GL_ARRAY_BUFFER, cell_count, nullptr, GL_DYNAMIC_DRAW);
+            track_vertex_array();
+            track_buffer(cell_count);
+            glVertexAttribIPointer(2, 1, GL_UNSIGNED_BYTE, sizeof(GLubyte), (GLvoid*)0);
+            glEnableVertexAttribArray(2);
+            glVertexAttribDivisor(2, 1);
+            upload_chunk(chunk);
+        }
+    }
+    glBindVertexArray(0);
+}
+
+void MapRenderer::upload_chunk(Chunk &chunk)
+{
+    const int width = chunk.bounds.col_end - chunk.bounds.col_begin;
+    const int height = chunk.bounds.row_end - chunk.bounds.row_begin;
+    for (int i=0; i<height; ++i) {
+        const game::Map::CellType *row = map_->data() + (chunk.bounds.row_begin + i) * map_->col_count();
+        std::copy(row + chunk.bounds.col_begin, row + chunk.bounds.col_end, chunk_staging_.begin() + i * width);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.cellTypeVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, width * height, chunk_staging_.data());
+    chunk.revision = map_->revision();
+}
+
+bool MapRenderer::visible_chunks(const glm::mat4 &viewMatrix, int &chunk_row_begin, int &chunk_col_begin,
+                                 int &chunk_row_end, int &chunk_col_end) const
+{
+    // the view is an axis aligned affine transformation, so the corners of the clip space
+    // square span the visible rectangle in cell units
+    const glm::mat4 inverse = glm::inverse(viewMatrix);
+    const glm::vec4 a = inverse * glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f);
+    const glm::vec4 b = inverse * glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+    // cell j covers [2j - col_count, 2j - col_count + 2] along x, rows likewise along y
+    const float col_min = (std::min(a.x, b.x) + map_->col_count()) / 2;
+    const float col_max = (std::max(a.x, b.x) + map_->col_count()) / 2;
+    const float row_min = (std::min(a.y, b.y) + map_->row_count()) / 2;
+    const float row_max = (std::max(a.y, b.y) + map_->row_count()) / 2;
+    if (col_max < 0 || row_max < 0 || col_min > map_->col_count() || row_min > map_->row_count()) {
+        return false;
+    }
+    const int chunk_size = game::Map::chunk_size;
+    chunk_col_begin = std::max(0, static_cast<int>(std::floor(col_min / chunk_size)));
+    chunk_row_begin = std::max(0, static_cast<int>(std::floor(row_min / chunk_size)));
+    chunk_col_end = std::min(map_->chunk_col_count(), static_cast<int>(std::floor(col_max / chunk_size)) + 1);
+    chunk_row_end = std::min(map_->chunk_row_count(), static_cast<int>(std::floor(row_max / chunk_size)) + 1);
+    return true;
+}
+
+void MapRenderer::submit_chunked(RenderQueue &queue, int layer)
+{
+    draw_calls_ = 0;
+    const glm::mat4 viewMatrix = ortho_ * gridScale_;
+    int chunk_row_begin, chunk_col_begin, chunk_row_end, chunk_col_end;
+    if (!visible_chunks(viewMatrix, chunk_row_begin, chunk_col_begin, chunk_row_end, chunk_col_end)) {
+        return;
+    }
+
+    for (int chunk_row=chunk_row_begin; chunk_row<chunk_row_end; ++chunk_row) {
+        for (int chunk_col=chunk_col_begin; chunk_col<chunk_col_end; ++chunk_col) {
+            Chunk &chunk = chunks_[chunk_row * map_->chunk_col_count() + chunk_col];
+            // chunks are only brought up to date once they become visible
+            if (map_->chunk_revision(chunk_row, chunk_col) > chunk.revision) {
+                upload_chunk(chunk);
+            }
+            const int width = chunk.bounds.col_end - chunk.bounds.col_begin;
+            const int height = chunk.bounds.row_end - chunk.bounds.row_begin;
+            queue.add(layer, chunkProgram_->gl_ref(), chunk.vao, 0, false,
+                      DrawCall::arrays(GL_TRIANGLES, 0, 6, width * height));
+            queue.set_uniform(chunkViewMatrixLocation_, viewMatrix);
+            queue.set_uniform(chunkOriginLocation_, chunk.origin);
+            queue.set_uniform(chunkWidthLocation_, width);
+            ++draw_calls_;
+        }
+    }
+}
+
+bool MapRenderer::init_tilemap()
+{
+    GLint max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    if (map_->row_count() > max_size || map_->col_count() > max_size) {
+        std::cerr << "the map does not fit a " << max_size << " texture, drawing it instanced\n";
+        return false;
+    }
+    tilemapProgram_ = ProgramCache::shared().get(tilemapVertexShaderSource, tilemapFragmentShaderSource);
+    tilemapViewMatrixLocation_ = tilemapProgram_->uniform_location("viewMatrix");
+    tilemapMapSizeLocation_ = tilemapProgram_->uniform_location("mapSize");
+    tilemapCellsLocation_ = tilemapProgram_->uniform_location("cells");
+
+    // the quad has no vertex attributes, but the core profile needs a vertex array to draw
+    glGenVertexArrays(1, &tilemapVao_);
+
+    glGenTextures(1, &cellTexture_);
+    glBindTexture(GL_TEXTURE_2D, cellTexture_);
+    // integer textures cannot be filtered
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, map_->col_count(), map_->row_count(), 0,
+                 GL_RED_INTEGER, GL_UNSIGNED_BYTE, map_->data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    track_vertex_array();
+    track_texture(map_->cell_count());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    revision_ = map_->revision();
+    return true;
+}
+
+void MapRenderer::submit_tilemap(RenderQueue &queue, int layer)
+{
+    glActiveTexture(GL_TEXTURE0);
+    sync_cell_types();
+    queue.add(layer, tilemapProgram_->gl_ref(), tilemapVao_, cellTexture_, false,
+              DrawCall::arrays(GL_TRIANGLE_STRIP, 0, 4));
+    queue.set_uniform(tilemapViewMatrixLocation_, ortho_ * gridScale_);
+    queue.set_uniform(tilemapMapSizeLocation_, glm::vec2(map_->col_count(), map_->row_count()));
+    queue.set_uniform(tilemapCellsLocation_, 0);
+    draw_calls_ = 1;
+}
+
+void MapRenderer::init_baked()
+{
+    bakedProgram_ = ProgramCache::shared().get(bakedVertexShaderSource, fragmentShaderSource);
+    bakedViewMatrixLocation_ = bakedProgram_->uniform_location("viewMatrix");
+
+    const GLuint vertex_count = 4 * static_cast<GLuint>(map_->cell_count());
+    std::vector<GLuint> indices;
+    indices.reserve(6 * map_->cell_count());
+    for (GLuint first=0; first<vertex_count; first+=4) {
+        const GLuint quad[6] = {first, first + 1, first + 2, first + 2, first + 3, first};
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+
+    glGenVertexArrays(1, &bakedVao_);
+    glGenBuffers(1, &bakedVbo_);
+    glGenBuffers(1, &bakedIbo_);
+    glBindVertexArray(bakedVao_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, bakedVbo_);
+    glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(BakedVertex), nullptr, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (GLvoid*)offsetof(BakedVertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_BYTE, sizeof(BakedVertex), (GLvoid*)offsetof(BakedVertex, cellType));
+    glEnableVertexAttribArray(2);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bakedIbo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    track_vertex_array();
+    track_buffer(vertex_count * sizeof(BakedVertex));
+    track_buffer(indices.size() * sizeof(GLuint));
+
+    baked_staging_.reserve(4 * game::Map::chunk_size * game::Map::chunk_size);
+    bakedChunkFirst_.resize(map_->chunk_row_count() * map_->chunk_col_count());
+    GLuint first = 0;
+    for (int chunk_row=0; chunk_row<map_->chunk_row_count(); ++chunk_row) {
+        for (int chunk_col=0; chunk_col<map_->chunk_col_count(); ++chunk_col) {
+            bakedChunkFirst_[chunk_row * map_->chunk_col_count() + chunk_col] = first;
+            bake_chunk(chunk_row, chunk_col);
+            glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(BakedVertex),
+                            baked_staging_.size() * sizeof(BakedVertex), baked_staging_.data());
+            first += static_cast<GLuint>(baked_staging_.size());
+        }
+    }
+    revision_ = map_->revision();
+}
+
+void MapRenderer::bake_chunk(int chunk_row, int chunk_col)
+{
+    const game::Map::ChunkBounds bounds = map_->chunk_bounds(chunk_row, chunk_col);
+    baked_staging_.clear();
+    // cell j covers [2j - col_count, 2j - col_count + 2] along x, rows likewise along y
+    for (int i=bounds.row_begin; i<bounds.row_end; ++i) {
+        const GLfloat bottom = 2.0f * i - map_->row_count();
+        for (int j=bounds.col_begin; j<bounds.col_end; ++j) {
+            const GLfloat left = 2.0f * j - map_->col_count();
+            const GLubyte type = map_->cell(i, j);
+            const BakedVertex corners[4] = {
+                {left, bottom, type, {0, 0, 0}},
+                {left + 2.0f, bottom, type, {0, 0, 0}},
+                {left + 2.0f, bottom + 2.0f, type, {0, 0, 0}},
+                {left, bottom + 2.0f, type, {0, 0, 0}}
+            };
+            baked_staging_.insert(baked_staging_.end(), corners, corners + 4);
+        }
+    }
+}
+
+void MapRenderer::submit_baked(RenderQueue &queue, int layer)
+{
+    if (revision_ != map_->revision()) {
+        glBindBuffer(GL_ARRAY_BUFFER, bakedVbo_);
+        for (int chunk_row=0; chunk_row<map_->chunk_row_count(); ++chunk_row) {
+            for (int chunk_col=0; chunk_col<map_->chunk_col_count(); ++chunk_col) {
+                if (map_->chunk_revision(chunk_row, chunk_col) <= revision_) {
+                    continue;
+                }
+                bake_chunk(chunk_row, chunk_col);
+                const GLuint first = bakedChunkFirst_[chunk_row * map_->chunk_col_count() + chunk_col];
+                glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(BakedVertex),
+                                baked_staging_.size() * sizeof(BakedVertex), baked_staging_.data());
+            }
+        }
+        revision_ = map_->revision();
+    }
+    queue.add(layer, bakedProgram_->gl_ref(), bakedVao_, 0, false,
+              DrawCall::elements(GL_TRIANGLES, 6 * map_->cell_count()));
+    queue.set_uniform(bakedViewMatrixLocation_, ortho_ * gridScale_);
+    draw_calls_ = 1;
+}
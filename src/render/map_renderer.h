@@ -0,0 +1,243 @@
+#ifndef MAP_RENDERER_H
+#define MAP_RENDERER_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <game/map.h>
+#include <game/resource_counter.h>
+
+#include "program_cache.h"
+#include "render_queue.h"
+
+namespace render {
+
+    /**
+     * @brief The MapRenderer class draws every cell of a game::Map as a quad
+     *
+     * Three strategies are available: PerCell issues one draw call per cell with its own
+     * view matrix, Instanced keeps the per-cell offsets in an instance attribute buffer
+     * and draws the whole grid with a single glDrawArraysInstanced call. Chunked gives every
+     * game::Map chunk its own cell type buffer and draws only the chunks that intersect the
+     * current view, one instanced draw call per visible chunk. Tilemap keeps the cell
+     * types in a GL_R8UI texture and draws a single quad over the map, its fragment shader
+     * fetches the cell under each pixel, so the vertex work does not depend on the map size.
+     * Baked builds four vertices and six indices per cell once into static buffers and draws
+     * the whole map with one glDrawElements, the vertices of a chunk are rebuilt when one of
+     * its cells changes.
+     *
+     * The map is scaled such that its rows span [-1, 1] vertically and its columns
+     * [-aspect_ratio(), aspect_ratio()] horizontally, which is the content rectangle
+     * computeOrthoMatrix() expects for the same aspect ratio.
+     *
+     * The renderer does not own the map, it observes the live game::Map, which must outlive
+     * it, and re-uploads the cell types of the chunks that changed since the last frame.
+     * observe() switches to another copy of the same map, such as a newer snapshot published
+     * by the simulation thread, without uploading chunks that did not change in between.
+     */
+    class MapRenderer {
+    public:
+        enum Mode {
+            PerCell,
+            Instanced,
+            Chunked,
+            Tilemap,
+            Baked
+        };
+
+        static const char *mode_name(Mode mode);
+
+        /**
+         * @brief buffers, textures and vertex_arrays count the GL objects of all map renderers
+         * and the memory of their contents
+         */
+        static game::ResourceCounter buffers;
+        static game::ResourceCounter textures;
+        static game::ResourceCounter vertex_arrays;
+
+        /**
+         * @brief aspect_ratio is the width of the rendered map divided by its height
+         */
+        static float aspect_ratio(const game::Map &map);
+
+        MapRenderer(const game::Map &map, glm::mat4x4 &ortho, Mode mode = Mode::Instanced);
+        ~MapRenderer();
+
+        MapRenderer(const MapRenderer &) = delete;
+        MapRenderer &operator=(const MapRenderer &) = delete;
+
+        /**
+         * @brief observe makes the renderer draw a different instance of the map it was created for
+         *
+         * The map must have the same size and share the revision history of the map observed
+         * so far, i.e. be a copy of it or of a map it was copied from.
+         */
+        void observe(const game::Map &map);
+
+        /**
+         * @brief submit queues the draws of the map, uploading the cells that changed first
+         */
+        void submit(RenderQueue &queue, int layer = 0);
+
+        /**
+         * @brief draw_calls tells how many draw calls the last submit() queued
+         */
+        int draw_calls() const
+        {
+            return draw_calls_;
+        }
+
+    private:
+        /**
+         * @brief The Chunk struct holds the GPU copy of one game::Map chunk
+         */
+        struct Chunk {
+            game::Map::ChunkBounds bounds;
+            // offset of the first cell of the chunk, in cell units
+            glm::vec2 origin;
+            GLuint cellTypeVbo;
+            GLuint vao;
+            game::Map::Revision revision;
+        };
+
+        /**
+         * @brief init_instancing uploads the offset of each cell, in cell units, and the cell types
+         * to per-instance attribute buffers and records them together with the quad vertices in
+         * instanceVao_
+         */
+        void init_instancing();
+
+        /**
+         * @brief sync_cell_types uploads the cell types of all chunks modified since the last
+         * upload, adjacent modified chunks of a chunk row are merged into one range
+         */
+        void sync_cell_types();
+
+        /**
+         * @brief upload_cell_types copies a rectangle of cell types to the bound cell type buffer,
+         * one glBufferSubData per row unless the rectangle spans whole rows, or to the bound cell
+         * texture with a single glTexSubImage2D
+         */
+        void upload_cell_types(int row_begin, int col_begin, int row_end, int col_end);
+
+        /**
+         * @brief init_chunks creates one cell type buffer and vertex array per map chunk
+         */
+        void init_chunks();
+
+        /**
+         * @brief upload_chunk gathers the rows of a chunk into one block and uploads it to the
+         * cell type buffer of the chunk
+         */
+        void upload_chunk(Chunk &chunk);
+
+        /**
+         * @brief init_tilemap creates the cell texture and the vertex array of the map quad
+         * @return false if the map is larger than the biggest texture the GL supports
+         */
+        bool init_tilemap();
+
+        /**
+         * @brief track_buffer, track_texture and track_vertex_array count a GL object of this
+         * renderer, the destructor releases all of them
+         */
+        void track_buffer(std::size_t bytes);
+        void track_texture(std::size_t bytes);
+        void track_vertex_array();
+
+        /**
+         * @brief visible_chunks computes the range of chunks that intersect the current view
+         * @return false if no chunk is visible, otherwise the half-open chunk ranges are stored
+         * in the given references
+         */
+        bool visible_chunks(const glm::mat4 &viewMatrix, int &chunk_row_begin, int &chunk_col_begin,
+                            int &chunk_row_end, int &chunk_col_end) const;
+
+        void submit_per_cell(RenderQueue &queue, int layer);
+        void submit_instanced(RenderQueue &queue, int layer);
+        void submit_chunked(RenderQueue &queue, int layer);
+        void submit_tilemap(RenderQueue &queue, int layer);
+        void submit_baked(RenderQueue &queue, int layer);
+
+        /**
+         * @brief init_baked builds the vertices and indices of all cells into static buffers
+         */
+        void init_baked();
+
+        /**
+         * @brief bake_chunk writes the vertices of a chunk to baked_staging_, the cells row by row
+         */
+        void bake_chunk(int chunk_row, int chunk_col);
+
+        GLfloat vertices[18] = {
+            -1.0f, 1.0f, 0.0f,
+            -1.0f, -1.0f, 0.0f,
+            1.0f, -1.0f, 0.0f,
+            1.0f, -1.0f, 0.0f,
+            1.0f, 1.0f, 0.0f,
+            -1.0f, 1.0f, 0.0f
+        };
+
+        std::shared_ptr<Program> program_;
+        GLuint cellVbo_;
+        GLuint cellVao_;
+        GLuint offsetVbo_ = 0;
+        GLuint cellTypeVbo_ = 0;
+        GLuint instanceVao_ = 0;
+        GLint viewMatrixLocation_;
+        glm::mat4 gridScale_;
+        glm::mat4x4 &ortho_;
+        Mode mode_;
+        int draw_calls_;
+        // what the track functions counted
+        std::size_t buffer_bytes_ = 0;
+        long buffer_count_ = 0;
+        std::size_t texture_bytes_ = 0;
+        long texture_count_ = 0;
+        long vertex_array_count_ = 0;
+
+        const game::Map *map_;
+        game::Map::Revision revision_;
+
+        std::shared_ptr<Program> chunkProgram_;
+        GLint chunkViewMatrixLocation_;
+        GLint chunkOriginLocation_;
+        GLint chunkWidthLocation_;
+        std::vector<Chunk> chunks_;
+        std::vector<game::Map::CellType> chunk_staging_;
+
+        std::shared_ptr<Program> tilemapProgram_;
+        GLint tilemapViewMatrixLocation_;
+        GLint tilemapMapSizeLocation_;
+        GLint tilemapCellsLocation_;
+        GLuint cellTexture_ = 0;
+        GLuint tilemapVao_ = 0;
+
+        /**
+         * @brief The BakedVertex struct is one corner of a cell in the baked geometry
+         */
+        struct BakedVertex {
+            GLfloat x;
+            GLfloat y;
+            GLubyte cellType;
+            GLubyte padding[3];
+        };
+        std::shared_ptr<Program> bakedProgram_;
+        GLint bakedViewMatrixLocation_;
+        GLuint bakedVbo_ = 0;
+        GLuint bakedIbo_ = 0;
+        GLuint bakedVao_ = 0;
+        // the first vertex of each chunk, chunks are stored one after the other
+        std::vector<GLuint> bakedChunkFirst_;
+        std::vector<BakedVertex> baked_staging_;
+    };
+
+}
+
+#endif // MAP_RENDERER_H
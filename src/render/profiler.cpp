@@ -0,0 +1,206 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+#include <game/resource_counter.h>
+
+using namespace render;
+
+constexpr int FrameProfiler::query_buffers;
+
+RollingStats::RollingStats(std::size_t capacity)
+    : capacity_(capacity),
+      next_(0)
+{
+    samples_.reserve(capacity_);
+}
+
+void RollingStats::add(double value)
+{
+    if (samples_.size() < capacity_) {
+        samples_.push_back(value);
+        return;
+    }
+    samples_[next_] = value;
+    next_ = (next_ + 1) % capacity_;
+}
+
+double RollingStats::min() const
+{
+    if (samples_.empty()) {
+        return 0.0;
+    }
+    return *std::min_element(samples_.begin(), samples_.end());
+}
+
+double RollingStats::avg() const
+{
+    if (samples_.empty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double sample : samples_) {
+        sum += sample;
+    }
+    return sum / samples_.size();
+}
+
+double RollingStats::percentile(double fraction) const
+{
+    if (samples_.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted(samples_);
+    std::size_t index = std::min(static_cast<std::size_t>(fraction * sorted.size()), sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+const char *FrameProfiler::stage_name(Stage stage)
+{
+    switch (stage) {
+    case Stage::Poll:
+        return "poll";
+    case Stage::Update:
+        return "update";
+    case Stage::Render:
+        return "render";
+    case Stage::Swap:
+        return "swap";
+    default:
+        return "unknown";
+    }
+}
+
+FrameProfiler::FrameProfiler(std::size_t window)
+    : current_(0),
+      cpu_(StageCount, RollingStats(window)),
+      gpu_(StageCount, RollingStats(window)),
+      frame_(window)
+{
+    glGenQueries(query_buffers * StageCount, &queries_[0][0]);
+    std::fill(&query_pending_[0][0], &query_pending_[0][0] + query_buffers * StageCount, false);
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    glDeleteQueries(query_buffers * StageCount, &queries_[0][0]);
+}
+
+void FrameProfiler::begin_frame()
+{
+    current_ = (current_ + 1) % query_buffers;
+    collect_gpu_results(current_);
+    frame_start_ = Clock::now();
+}
+
+void FrameProfiler::end_frame()
+{
+    frame_.add(std::chrono::duration<double, std::milli>(Clock::now() - frame_start_).count());
+}
+
+void FrameProfiler::begin(Stage stage)
+{
+    glBeginQuery(GL_TIME_ELAPSED, queries_[current_][stage]);
+    stage_start_[stage] = Clock::now();
+}
+
+void FrameProfiler::end(Stage stage)
+{
+    cpu_[stage].add(std::chrono::duration<double, std::milli>(Clock::now() - stage_start_[stage]).count());
+    glEndQuery(GL_TIME_ELAPSED);
+    query_pending_[current_][stage] = true;
+}
+
+void FrameProfiler::collect_gpu_results(int buffer)
+{
+    for (int stage=0; stage<StageCount; ++stage) {
+        if (!query_pending_[buffer][stage]) {
+            continue;
+        }
+        query_pending_[buffer][stage] = false;
+        // blocks only if the GPU is more than query_buffers frames behind
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(queries_[buffer][stage], GL_QUERY_RESULT, &elapsed_ns);
+        gpu_[stage].add(elapsed_ns / 1.0e6);
+    }
+}
+
+void FrameProfiler::print(std::ostream &out) const
+{
+    out << std::fixed << std::setprecision(3)
+        << std::setw(8) << "stage" << std::setw(6) << "clock"
+        << std::setw(10) << "min ms" << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << "\n";
+    for (int stage=0; stage<StageCount; ++stage) {
+        const RollingStats *stats[] = {&cpu_[stage], &gpu_[stage]};
+        const char *clocks[] = {"cpu", "gpu"};
+        for (int i=0; i<2; ++i) {
+            out << std::setw(8) << stage_name(static_cast<Stage>(stage)) << std::setw(6) << clocks[i]
+                << std::setw(10) << stats[i]->min() << std::setw(10) << stats[i]->avg()
+                << std::setw(10) << stats[i]->percentile(0.99) << "\n";
+        }
+    }
+    out << std::setw(8) << "frame" << std::setw(6) << "cpu"
+        << std::setw(10) << frame_.min() << std::setw(10) << frame_.avg()
+        << std::setw(10) << frame_.percentile(0.99) << "\n\n";
+    game::printResourceCounters(out);
+    out.flush();
+}
+
+bool FrameProfiler::write_csv(const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "stage,clock,samples,min_ms,avg_ms,p99_ms\n";
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (int stage=0; stage<StageCount; ++stage) {
+        const RollingStats *stats[] = {&cpu_[stage], &gpu_[stage]};
+        const char *clocks[] = {"cpu", "gpu"};
+        for (int i=0; i<2; ++i) {
+            out << stage_name(static_cast<Stage>(stage)) << ',' << clocks[i] << ','
+                << stats[i]->count() << ',' << stats[i]->min() << ',' << stats[i]->avg() << ','
+                << stats[i]->percentile(0.99) << "\n";
+        }
+    }
+    out << "frame,cpu," << frame_.count() << ',' << frame_.min() << ',' << frame_.avg() << ','
+        << frame_.percentile(0.99) << "\n";
+    return static_cast<bool>(out);
+}
+
+namespace {
+
+void writeStatsJson(std::ostream &out, const RollingStats &stats)
+{
+    out << "{\"samples\": " << stats.count() << ", \"min_ms\": " << stats.min()
+        << ", \"avg_ms\": " << stats.avg() << ", \"p99_ms\": " << stats.percentile(0.99) << "}";
+}
+
+}
+
+bool FrameProfiler::write_json(const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    out << "{\n  \"stages\": {\n";
+    for (int stage=0; stage<StageCount; ++stage) {
+        out << "    \"" << stage_name(static_cast<Stage>(stage)) << "\": {\"cpu\": ";
+        writeStatsJson(out, cpu_[stage]);
+        out << ", \"gpu\": ";
+        writeStatsJson(out, gpu_[stage]);
+        out << (stage + 1 < StageCount ? "},\n" : "}\n");
+    }
+    out << "  },\n  \"frame\": ";
+    writeStatsJson(out, frame_);
+    out << ",\n  \"resources\": ";
+    game::writeResourceJson(out, 2);
+    out << "\n}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,151 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace render {
+
+    /**
+     * @brief The RollingStats class keeps the last capacity samples of a measurement
+     *
+     * Older samples are overwritten, such that the statistics describe recent behaviour
+     * rather than the whole run.
+     */
+    class RollingStats
+    {
+    public:
+        explicit RollingStats(std::size_t capacity);
+
+        void add(double value);
+
+        std::size_t count() const {
+            return samples_.size();
+        }
+        double min() const;
+        double avg() const;
+
+        /**
+         * @brief percentile computes the value below which the given fraction of samples lie
+         * @param fraction a value in [0, 1], e.g. 0.99 for the 99th percentile
+         * @return the percentile, or 0 if there are no samples
+         */
+        double percentile(double fraction) const;
+    private:
+        std::size_t capacity_;
+        std::size_t next_;
+        std::vector<double> samples_;
+    };
+
+    /**
+     * @brief The FrameProfiler class measures the CPU and GPU time of each main loop stage
+     *
+     * CPU time is taken with a high resolution clock around every stage. GPU time is measured
+     * with GL_TIME_ELAPSED queries from a ring of query_buffers sets: the results of a set are
+     * only read when the set is reused query_buffers frames later. Drivers queue at most a few
+     * frames, so the results are available by then and reading them does not wait for the GPU.
+     * A result that is not is waited for rather than dropped, because dropping the samples of
+     * the slowest frames would bias the GPU percentiles low.
+     *
+     * Stages must not overlap, because only one GL_TIME_ELAPSED query can be active at a time.
+     * All times are reported in milliseconds.
+     */
+    class FrameProfiler
+    {
+    public:
+        enum Stage {
+            Poll,
+            Update,
+            Render,
+            Swap,
+            StageCount
+        };
+
+        static const char *stage_name(Stage stage);
+
+        explicit FrameProfiler(std::size_t window = 600);
+        ~FrameProfiler();
+
+        FrameProfiler(const FrameProfiler &) = delete;
+        FrameProfiler &operator=(const FrameProfiler &) = delete;
+
+        void begin_frame();
+        void end_frame();
+
+        void begin(Stage stage);
+        void end(Stage stage);
+
+        const RollingStats &cpu_stats(Stage stage) const {
+            return cpu_[stage];
+        }
+        const RollingStats &gpu_stats(Stage stage) const {
+            return gpu_[stage];
+        }
+        const RollingStats &frame_stats() const {
+            return frame_;
+        }
+
+        /**
+         * @brief print writes a min/avg/p99 summary of every stage in a human readable table,
+         * followed by the table of game::ResourceCounter values
+         */
+        void print(std::ostream &out) const;
+
+        /**
+         * @brief write_csv writes the same summary as print() as comma separated values
+         * @return false if the file could not be written
+         */
+        bool write_csv(const std::string &path) const;
+
+        /**
+         * @brief write_json writes the stage statistics and every game::ResourceCounter as JSON
+         * @return false if the file could not be written
+         */
+        bool write_json(const std::string &path) const;
+    private:
+        typedef std::chrono::high_resolution_clock Clock;
+        static constexpr int query_buffers = 4;
+
+        void collect_gpu_results(int buffer);
+
+        GLuint queries_[query_buffers][StageCount];
+        bool query_pending_[query_buffers][StageCount];
+        int current_;
+        Clock::time_point frame_start_;
+        Clock::time_point stage_start_[StageCount];
+        std::vector<RollingStats> cpu_;
+        std::vector<RollingStats> gpu_;
+        RollingStats frame_;
+    };
+
+    /**
+     * @brief The ProfileScope class measures one stage for the lifetime of the object
+     */
+    class ProfileScope
+    {
+    public:
+        ProfileScope(FrameProfiler &profiler, FrameProfiler::Stage stage)
+            : profiler_(profiler),
+              stage_(stage)
+        {
+            profiler_.begin(stage_);
+        }
+
+        ~ProfileScope()
+        {
+            profiler_.end(stage_);
+        }
+    private:
+        FrameProfiler &profiler_;
+        FrameProfiler::Stage stage_;
+    };
+
+}
+
+#endif // PROFILER_H
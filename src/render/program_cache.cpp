@@ -0,0 +1,163 @@
+#include "program_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace render;
+
+namespace {
+
+const char cache_magic[4] = {'B', 'C', 'P', 'C'};
+const std::uint32_t cache_version = 1;
+
+const std::uint64_t fnv_offset = 14695981039346656037ull;
+
+/**
+ * @brief hashBytes continues a 64 bit FNV-1a hash over bytes
+ */
+std::uint64_t hashBytes(const char *bytes, std::size_t length, std::uint64_t hash)
+{
+    for (std::size_t i=0; i<length; ++i) {
+        hash ^= static_cast<unsigned char>(bytes[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::uint64_t hashString(const char *text, std::uint64_t hash)
+{
+    // include the terminator, such that the boundary between two strings is part of the hash
+    return hashBytes(text != nullptr ? text : "", text != nullptr ? std::strlen(text) + 1 : 1, hash);
+}
+
+template <typename T>
+void writeValue(std::ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::istream &in, T &value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+}
+
+ProgramCache &ProgramCache::shared()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+ProgramCache::ProgramCache()
+    : driver_(0),
+      compile_count_(0)
+{
+}
+
+std::uint64_t ProgramCache::driver_hash() const
+{
+    std::uint64_t hash = hashString(reinterpret_cast<const char*>(glGetString(GL_VENDOR)), fnv_offset);
+    hash = hashString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), hash);
+    return hashString(reinterpret_cast<const char*>(glGetString(GL_VERSION)), hash);
+}
+
+bool ProgramCache::open(const std::string &path)
+{
+    path_ = path;
+    driver_ = driver_hash();
+    binaries_.clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        // there is no cache yet, it is created with the first program
+        return true;
+    }
+    char magic[4];
+    std::uint32_t version = 0;
+    std::uint64_t driver = 0;
+    std::uint32_t count = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, cache_magic, sizeof(magic)) != 0
+            || !readValue(file, version) || version != cache_version
+            || !readValue(file, driver) || !readValue(file, count)) {
+        std::cerr << "ignoring invalid shader cache " << path << "\n";
+        return false;
+    }
+    if (driver != driver_) {
+        // binaries of another driver are useless, they are replaced as programs are compiled
+        return true;
+    }
+    // the lengths of the binaries are checked against the file size before anything is allocated
+    const std::streampos entries = file.tellg();
+    file.seekg(0, std::ios::end);
+    const std::streamoff file_size = file.tellg();
+    file.seekg(entries);
+    for (std::uint32_t i=0; i<count; ++i) {
+        std::uint64_t key = 0;
+        std::uint32_t length = 0;
+        Binary binary;
+        if (!readValue(file, key) || !readValue(file, binary.format) || !readValue(file, length)
+                || static_cast<std::streamoff>(length) > file_size - static_cast<std::streamoff>(file.tellg())) {
+            std::cerr << "ignoring truncated shader cache " << path << "\n";
+            binaries_.clear();
+            return false;
+        }
+        binary.data.resize(length);
+        if (!file.read(binary.data.data(), length)) {
+            std::cerr << "ignoring truncated shader cache " << path << "\n";
+            binaries_.clear();
+            return false;
+        }
+        binaries_[key] = std::move(binary);
+    }
+    return true;
+}
+
+bool ProgramCache::save() const
+{
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(cache_magic, sizeof(cache_magic));
+    writeValue(file, cache_version);
+    writeValue(file, driver_);
+    writeValue(file, static_cast<std::uint32_t>(binaries_.size()));
+    for (const auto &entry : binaries_) {
+        writeValue(file, entry.first);
+        writeValue(file, entry.second.format);
+        writeValue(file, static_cast<std::uint32_t>(entry.second.data.size()));
+        file.write(entry.second.data.data(), entry.second.data.size());
+    }
+    return static_cast<bool>(file);
+}
+
+std::shared_ptr<Program> ProgramCache::get(const GLchar *vertex_source, const GLchar *fragment_source)
+{
+    const std::uint64_t key = hashString(fragment_source, hashString(vertex_source, fnv_offset));
+    std::shared_ptr<Program> program = programs_[key].lock();
+    if (program) {
+        return program;
+    }
+
+    auto binary = binaries_.find(key);
+    if (binary != binaries_.end()) {
+        program = Program::from_binary(binary->second.format, binary->second.data);
+    }
+    if (!program) {
+        VertexShader vertex_shader(vertex_source);
+        FragmentShader fragment_shader(fragment_source);
+        program = std::make_shared<Program>(std::vector<Shader*>{&vertex_shader, &fragment_shader});
+        ++compile_count_;
+        Binary compiled;
+        if (!path_.empty() && program->binary(compiled.format, compiled.data)) {
+            binaries_[key] = std::move(compiled);
+            if (!save()) {
+                std::cerr << "could not write shader cache " << path_ << "\n";
+            }
+        }
+    }
+    programs_[key] = program;
+    return program;
+}
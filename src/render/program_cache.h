@@ -0,0 +1,76 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "shader.h"
+
+namespace render {
+
+    /**
+     * @brief The ProgramCache class hands out shader programs, each set of sources is only
+     * compiled once
+     *
+     * Programs are identified by a hash of their sources. While some renderer still holds a
+     * program, get() returns that same program for the same sources. With a cache file set,
+     * the linked binaries of all programs are kept on disk, keyed additionally by the driver
+     * that produced them, and later runs load them with glProgramBinary instead of compiling.
+     * Binaries the driver rejects are compiled again and replace the stale ones in the file.
+     *
+     * All methods must be called with the OpenGL context current.
+     */
+    class ProgramCache
+    {
+    public:
+        /**
+         * @brief shared is the cache used by the renderers
+         */
+        static ProgramCache &shared();
+
+        /**
+         * @brief open loads the binaries stored in a cache file and keeps new ones there
+         * @return false if the file exists but could not be read, it is rewritten then
+         */
+        bool open(const std::string &path);
+
+        /**
+         * @brief get finds or builds the program of a vertex and a fragment shader source
+         * @return the program, which is not linked if the sources have errors
+         */
+        std::shared_ptr<Program> get(const GLchar *vertex_source, const GLchar *fragment_source);
+
+        /**
+         * @brief compile_count tells how many programs had to be compiled from source
+         */
+        int compile_count() const {
+            return compile_count_;
+        }
+
+    private:
+        struct Binary {
+            GLenum format;
+            std::vector<char> data;
+        };
+
+        ProgramCache();
+
+        bool save() const;
+        std::uint64_t driver_hash() const;
+
+        std::string path_;
+        std::uint64_t driver_;
+        std::unordered_map<std::uint64_t, std::weak_ptr<Program>> programs_;
+        std::unordered_map<std::uint64_t, Binary> binaries_;
+        int compile_count_;
+    };
+
+}
+
+#endif // PROGRAM_CACHE_H
@@ -0,0 +1,16 @@
+#include "projection.h"
+
+#include <cassert>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+glm::mat4x4 render::computeOrthoMatrix(int width, int height, float aspect)
+{
+    assert(height > 0);
+    assert(aspect > 0);
+    float ratio = static_cast<float>(width) / height;
+    if (ratio > aspect) {
+        return glm::ortho(-ratio, ratio, -1.0f, 1.0f);
+    }
+    return glm::ortho(-aspect, aspect, -aspect/ratio, aspect/ratio);
+}
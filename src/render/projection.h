@@ -0,0 +1,23 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include <glm/glm.hpp>
+
+namespace render {
+
+    /**
+     * @brief computeOrthoMatrix creates an orthographic projection matrix for 2D rendering
+     *
+     * The function takes the aspect ratio into account, such that content fits all window
+     * configurations, such as narrow and tall, or wide and thin. The content is the rectangle
+     * [-aspect, aspect] x [-1, 1], it is shown as large as possible without being cut off.
+     * @param width the width of the window
+     * @param height the height of the window, must be greater than 1
+     * @param aspect the width of the content divided by its height, must be greater than 0
+     * @return a glm::mat4x4 matrix object that describes the orthographic projection transformation
+     */
+    glm::mat4x4 computeOrthoMatrix(int width, int height, float aspect = 1.0f);
+
+}
+
+#endif // PROJECTION_H
@@ -0,0 +1,142 @@
+#include "render_queue.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace render;
+
+DrawCall DrawCall::arrays(GLenum primitive, GLint first, GLsizei count, GLsizei instances)
+{
+    DrawCall call = {primitive, false, first, count, 0, instances};
+    return call;
+}
+
+DrawCall DrawCall::elements(GLenum primitive, GLsizei count, GLint base_vertex, GLsizei instances)
+{
+    DrawCall call = {primitive, true, 0, count, base_vertex, instances};
+    return call;
+}
+
+RenderQueue::RenderQueue()
+    : items_(game::ArenaAllocator<Item>(arena_)),
+      values_(game::ArenaAllocator<Value>(arena_)),
+      floats_(game::ArenaAllocator<GLfloat>(arena_)),
+      draw_calls_(0),
+      state_changes_(0),
+      skipped_changes_(0)
+{
+}
+
+void RenderQueue::add(int layer, GLuint program, GLuint vao, GLuint texture, bool blend, const DrawCall &call)
+{
+    Item item;
+    // names only group items, truncating them can merely split a group
+    item.key = (static_cast<std::uint64_t>(layer & 0xffff) << 48)
+            | (static_cast<std::uint64_t>(blend ? 1 : 0) << 47)
+            | (static_cast<std::uint64_t>(program & 0x7fff) << 32)
+            | (static_cast<std::uint64_t>(texture & 0xffff) << 16)
+            | (vao & 0xffff);
+    item.sequence = static_cast<std::uint32_t>(items_.size());
+    item.program = program;
+    item.vao = vao;
+    item.texture = texture;
+    item.blend = blend;
+    item.call = call;
+    item.first_value = static_cast<std::uint32_t>(values_.size());
+    item.value_count = 0;
+    items_.push_back(item);
+}
+
+void RenderQueue::set_uniform(GLint location, const glm::mat4 &value)
+{
+    const GLfloat *data = glm::value_ptr(value);
+    add_value(Value::Matrix, location, static_cast<GLint>(floats_.size()));
+    floats_.insert(floats_.end(), data, data + 16);
+}
+
+void RenderQueue::set_uniform(GLint location, const glm::vec2 &value)
+{
+    add_value(Value::Vector, location, static_cast<GLint>(floats_.size()));
+    floats_.push_back(value.x);
+    floats_.push_back(value.y);
+}
+
+void RenderQueue::set_uniform(GLint location, GLint value)
+{
+    add_value(Value::Integer, location, value);
+}
+
+void RenderQueue::set_attribute(GLuint index, GLuint value)
+{
+    add_value(Value::Attribute, static_cast<GLint>(index), static_cast<GLint>(value));
+}
+
+void RenderQueue::add_value(Value::Kind kind, GLint location, GLint data)
+{
+    assert(!items_.empty());
+    Value value = {kind, location, data};
+    values_.push_back(value);
+    ++items_.back().value_count;
+}
+
+void RenderQueue::apply(const Value &value) const
+{
+    switch (value.kind) {
+    case Value::Matrix:
+        glUniformMatrix4fv(value.location, 1, GL_FALSE, floats_.data() + value.data);
+        break;
+    case Value::Vector:
+        glUniform2fv(value.location, 1, floats_.data() + value.data);
+        break;
+    case Value::Integer:
+        glUniform1i(value.location, value.data);
+        break;
+    case Value::Attribute:
+        glVertexAttribI1ui(static_cast<GLuint>(value.location), static_cast<GLuint>(value.data));
+        break;
+    }
+}
+
+void RenderQueue::execute()
+{
+    std::sort(items_.begin(), items_.end(), [](const Item &a, const Item &b) {
+        return a.key < b.key || (a.key == b.key && a.sequence < b.sequence);
+    });
+
+    // renderers upload and bind outside the queue, so nothing is known about the state
+    state_.invalidate();
+    state_.reset_counters();
+    for (const Item &item : items_) {
+        state_.use_program(item.program);
+        state_.bind_vertex_array(item.vao);
+        if (item.texture != 0) {
+            state_.bind_texture(item.texture);
+        }
+        state_.set_blend(item.blend);
+        for (std::uint32_t i=0; i<item.value_count; ++i) {
+            apply(values_[item.first_value + i]);
+        }
+        const DrawCall &call = item.call;
+        if (call.indexed) {
+            glDrawElementsInstancedBaseVertex(call.primitive, call.count, GL_UNSIGNED_INT,
+                                              (GLvoid*)0, call.instances, call.base_vertex);
+        } else if (call.instances == 1) {
+            glDrawArrays(call.primitive, call.first, call.count);
+        } else {
+            glDrawArraysInstanced(call.primitive, call.first, call.count, call.instances);
+        }
+    }
+    state_.bind_vertex_array(0);
+    state_.set_blend(false);
+    draw_calls_ = static_cast<int>(items_.size());
+    state_changes_ = state_.changes();
+    skipped_changes_ = state_.skipped();
+
+    // the containers have to let go of their arena memory before it is reset
+    game::ArenaVector<Item>(items_.get_allocator()).swap(items_);
+    game::ArenaVector<Value>(values_.get_allocator()).swap(values_);
+    game::ArenaVector<GLfloat>(floats_.get_allocator()).swap(floats_);
+    arena_.reset();
+}
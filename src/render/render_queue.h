@@ -0,0 +1,145 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <game/frame_arena.h>
+
+#include "gl_state_cache.h"
+
+namespace render {
+
+    /**
+     * @brief The DrawCall struct describes the draw of one queued item
+     *
+     * Indexed draws use GL_UNSIGNED_INT indices from the start of the element buffer of the
+     * vertex array, offset by base_vertex, and ignore first. Array draws start at the vertex
+     * first and ignore base_vertex.
+     */
+    struct DrawCall {
+        GLenum primitive;
+        bool indexed;
+        GLint first;
+        GLsizei count;
+        GLint base_vertex;
+        GLsizei instances;
+
+        static DrawCall arrays(GLenum primitive, GLint first, GLsizei count, GLsizei instances = 1);
+        static DrawCall elements(GLenum primitive, GLsizei count, GLint base_vertex = 0, GLsizei instances = 1);
+    };
+
+    /**
+     * @brief The RenderQueue class collects the draws of a frame and issues them sorted by state
+     *
+     * Renderers add() draw items with the layer, program, vertex array, texture and blending
+     * they need, followed by the uniform values of the item. execute() sorts the items by
+     * layer, then by blending, program, texture and vertex array, and issues them through a
+     * GlStateCache, so items sharing state cost one binding for all of them. Lower layers are
+     * drawn first, the order of items in a layer only holds among items with the same state.
+     *
+     * Uniforms are program state, so an item has to set every uniform its draw depends on.
+     * Items and their values live in a game::FrameArena, once a frame has the same shape as
+     * the previous one queuing it does not allocate.
+     */
+    class RenderQueue
+    {
+    public:
+        RenderQueue();
+
+        RenderQueue(const RenderQueue &) = delete;
+        RenderQueue &operator=(const RenderQueue &) = delete;
+
+        /**
+         * @brief add queues a draw item, texture 0 leaves the bound texture as it is
+         */
+        void add(int layer, GLuint program, GLuint vao, GLuint texture, bool blend, const DrawCall &call);
+
+        /**
+         * @brief set_uniform sets a uniform of the program of the item added last before its draw
+         */
+        void set_uniform(GLint location, const glm::mat4 &value);
+        void set_uniform(GLint location, const glm::vec2 &value);
+        void set_uniform(GLint location, GLint value);
+        /**
+         * @brief set_attribute sets the constant value of an unsigned integer vertex attribute
+         * that the vertex array of the item added last does not provide
+         */
+        void set_attribute(GLuint index, GLuint value);
+
+        /**
+         * @brief execute issues all queued items and empties the queue
+         */
+        void execute();
+
+        std::size_t size() const {
+            return items_.size();
+        }
+        /**
+         * @brief draw_calls tells how many draws the last execute() issued
+         */
+        int draw_calls() const {
+            return draw_calls_;
+        }
+        /**
+         * @brief state_changes tells how many bindings the last execute() passed to the driver
+         */
+        int state_changes() const {
+            return state_changes_;
+        }
+        /**
+         * @brief skipped_changes tells how many redundant bindings the last execute() dropped
+         */
+        int skipped_changes() const {
+            return skipped_changes_;
+        }
+
+    private:
+        struct Item {
+            std::uint64_t key;
+            // submission order, which breaks ties of the key
+            std::uint32_t sequence;
+            GLuint program;
+            GLuint vao;
+            GLuint texture;
+            bool blend;
+            DrawCall call;
+            std::uint32_t first_value;
+            std::uint32_t value_count;
+        };
+
+        struct Value {
+            enum Kind : std::uint8_t {
+                Matrix,
+                Vector,
+                Integer,
+                Attribute
+            };
+            Kind kind;
+            GLint location;
+            // the integer value, or the first of the floats of matrices and vectors
+            GLint data;
+        };
+
+        void add_value(Value::Kind kind, GLint location, GLint data);
+        void apply(const Value &value) const;
+
+        // the containers allocate from the arena, which is declared first to outlive them
+        game::FrameArena arena_;
+        game::ArenaVector<Item> items_;
+        game::ArenaVector<Value> values_;
+        game::ArenaVector<GLfloat> floats_;
+        GlStateCache state_;
+        int draw_calls_;
+        int state_changes_;
+        int skipped_changes_;
+    };
+
+}
+
+#endif // RENDER_QUEUE_H
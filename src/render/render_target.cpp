@@ -0,0 +1,133 @@
+#include "render_target.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+using namespace render;
+
+namespace {
+
+    /**
+     * @brief createColorTarget creates a framebuffer with an RGBA8 color renderbuffer
+     * @return false if the framebuffer is incomplete
+     */
+    bool createColorTarget(int width, int height, int samples, GLuint &framebuffer, GLuint &color) {
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &color);
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        if (samples > 0) {
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+        } else {
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return complete;
+    }
+
+}
+
+RenderTarget::RenderTarget()
+    : framebuffer_(0),
+      color_(0),
+      resolveFramebuffer_(0),
+      resolveColor_(0),
+      window_width_(1),
+      window_height_(1),
+      width_(1),
+      height_(1),
+      samples_(0),
+      magnification_(1)
+{
+}
+
+RenderTarget::~RenderTarget()
+{
+    release();
+}
+
+bool RenderTarget::resize(int window_width, int window_height, float scale, int samples)
+{
+    release();
+    window_width_ = std::max(window_width, 1);
+    window_height_ = std::max(window_height, 1);
+    GLint max_samples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    samples_ = std::min(std::max(samples, 0), static_cast<int>(max_samples));
+    if (scale < 1.0f) {
+        magnification_ = std::max(1, static_cast<int>(std::lround(1.0f / std::max(scale, 0.01f))));
+        width_ = (window_width_ + magnification_ - 1) / magnification_;
+        height_ = (window_height_ + magnification_ - 1) / magnification_;
+    } else {
+        magnification_ = 1;
+        width_ = std::max(1, static_cast<int>(std::lround(window_width_ * scale)));
+        height_ = std::max(1, static_cast<int>(std::lround(window_height_ * scale)));
+    }
+    if (width_ == window_width_ && height_ == window_height_ && samples_ == 0) {
+        return true;
+    }
+
+    bool complete = createColorTarget(width_, height_, samples_, framebuffer_, color_);
+    if (complete && samples_ > 0) {
+        complete = createColorTarget(width_, height_, 0, resolveFramebuffer_, resolveColor_);
+    }
+    if (!complete) {
+        std::cerr << "could not create a " << width_ << "x" << height_ << " render target with "
+                  << samples_ << " samples, rendering to the window\n";
+        release();
+        width_ = window_width_;
+        height_ = window_height_;
+        samples_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+}
+
+void RenderTarget::present()
+{
+    if (!active()) {
+        return;
+    }
+    GLuint source = framebuffer_;
+    if (samples_ > 0) {
+        // multisampled framebuffers can only be blitted at their own size
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFramebuffer_);
+        glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        source = resolveFramebuffer_;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    if (magnification_ > 1 || (width_ == window_width_ && height_ == window_height_)) {
+        // whole pixel blocks, the last ones may stick out of the window by less than a block
+        glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_ * magnification_, height_ * magnification_,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    } else {
+        glBlitFramebuffer(0, 0, width_, height_, 0, 0, window_width_, window_height_,
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, window_width_, window_height_);
+}
+
+void RenderTarget::release()
+{
+    glDeleteFramebuffers(1, &resolveFramebuffer_);
+    glDeleteRenderbuffers(1, &resolveColor_);
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteRenderbuffers(1, &color_);
+    resolveFramebuffer_ = 0;
+    resolveColor_ = 0;
+    framebuffer_ = 0;
+    color_ = 0;
+}
@@ -0,0 +1,88 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace render {
+
+    /**
+     * @brief The RenderTarget class renders a frame offscreen and scales it to the window
+     *
+     * The internal resolution follows the framebuffer size of the window in pixels times a
+     * scale. Scales below 1 are rounded to 1/k for a whole number k, the internal size is the
+     * framebuffer size divided by k, rounded up, and present() magnifies every internal pixel
+     * to exactly k x k window pixels with nearest filtering, which keeps the pixel art crisp.
+     * Scales above 1 render at a higher resolution and filter the frame down linearly.
+     *
+     * With samples above 0 the frame is rendered multisampled and resolved before scaling.
+     * A scale of 1 without multisampling renders straight into the window, so the target
+     * costs nothing when it is not configured.
+     */
+    class RenderTarget
+    {
+    public:
+        RenderTarget();
+        ~RenderTarget();
+
+        RenderTarget(const RenderTarget &) = delete;
+        RenderTarget &operator=(const RenderTarget &) = delete;
+
+        /**
+         * @brief resize creates the buffers for a framebuffer size, scale and number of samples
+         *
+         * The size is that of the window framebuffer in pixels, see glfwGetFramebufferSize(),
+         * which is larger than the window size in screen coordinates on high-DPI displays.
+         * @return false if the framebuffer is incomplete, frames go straight to the window then
+         */
+        bool resize(int window_width, int window_height, float scale, int samples);
+
+        /**
+         * @brief active is true if frames are rendered offscreen
+         */
+        bool active() const {
+            return framebuffer_ != 0;
+        }
+
+        /**
+         * @brief width is the horizontal resolution frames are rendered at
+         */
+        int width() const {
+            return width_;
+        }
+        int height() const {
+            return height_;
+        }
+        int samples() const {
+            return samples_;
+        }
+
+        /**
+         * @brief bind makes the target the framebuffer and viewport to render the frame to
+         */
+        void bind();
+
+        /**
+         * @brief present resolves and scales the frame into the window framebuffer
+         */
+        void present();
+
+    private:
+        void release();
+
+        GLuint framebuffer_;
+        GLuint color_;
+        // multisampled frames are resolved into these before they are scaled
+        GLuint resolveFramebuffer_;
+        GLuint resolveColor_;
+        int window_width_;
+        int window_height_;
+        int width_;
+        int height_;
+        int samples_;
+        int magnification_;
+    };
+
+}
+
+#endif // RENDER_TARGET_H
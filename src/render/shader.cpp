@@ -0,0 +1,160 @@
+#include "shader.h"
+
+#include <iostream>
+
+using namespace render;
+
+game::ResourceCounter Shader::counter("gl.shaders");
+game::ResourceCounter Program::counter("gl.programs");
+game::ResourceCounter Program::attachments("gl.attached_shaders");
+
+Shader::Shader(ShaderType shaderType, const GLchar* shaderSource): shader_(0)
+{
+    shader_source_ = shaderSource;
+    shader_type_ = shaderType;
+
+    shader_ = glCreateShader(shader_type_);
+    if (shader_ != 0) {
+        counter.acquire(0);
+    }
+    glShaderSource(shader_, 1, &shader_source_, NULL);
+    glCompileShader(shader_);
+    GLint success;
+    GLchar info_log[512];
+    glGetShaderiv(shader_, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader_, 512, NULL, info_log);
+        std::cerr << "ERROR::SHADER::" << shader_type_ << "::COMPILATION_FAILED\n" << info_log << "\n";
+    }
+}
+
+Shader::~Shader()
+{
+    if (shader_ != 0) {
+        glDeleteShader(shader_);
+        counter.release(0);
+    }
+}
+
+Program::Program()
+    : program_(glCreateProgram()),
+      linked_(false)
+{
+    if (program_ != 0) {
+        counter.acquire(0);
+    }
+}
+
+Program::Program(const std::vector<Shader*> &shaders)
+    : Program()
+{
+    for (auto it=shaders.begin(); it != shaders.end(); it++) {
+        glAttachShader(program_, (*it)->gl_ref());
+        attachments.acquire(0);
+    }
+    if (binary_supported()) {
+        glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program_);
+    // the linked program does not need the shaders anymore, let the driver release them
+    for (auto it=shaders.begin(); it != shaders.end(); it++) {
+        glDetachShader(program_, (*it)->gl_ref());
+        attachments.release(0);
+    }
+    if (check_link_status()) {
+        cache_uniform_locations();
+    }
+}
+
+std::unique_ptr<Program> Program::from_binary(GLenum format, const std::vector<char> &binary)
+{
+    if (!binary_supported() || binary.empty()) {
+        return nullptr;
+    }
+    std::unique_ptr<Program> program(new Program());
+    glProgramBinary(program->program_, format, binary.data(), static_cast<GLsizei>(binary.size()));
+    // drivers reject binaries of other driver versions, which is not worth an error message
+    GLint success = GL_FALSE;
+    glGetProgramiv(program->program_, GL_LINK_STATUS, &success);
+    if (!success) {
+        return nullptr;
+    }
+    program->linked_ = true;
+    program->cache_uniform_locations();
+    return program;
+}
+
+bool Program::binary_supported()
+{
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary) {
+        return false;
+    }
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    return format_count > 0;
+}
+
+bool Program::binary(GLenum &format, std::vector<char> &binary) const
+{
+    if (!linked_ || !binary_supported()) {
+        return false;
+    }
+    GLint length = 0;
+    glGetProgramiv(program_, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    binary.resize(length);
+    GLsizei written = 0;
+    glGetProgramBinary(program_, length, &written, &format, binary.data());
+    binary.resize(written);
+    return written > 0;
+}
+
+bool Program::check_link_status()
+{
+    GLint success;
+    GLchar info_log[512];
+    glGetProgramiv(program_, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program_, 512, NULL, info_log);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << info_log << "\n";
+        return false;
+    }
+    linked_ = true;
+    return true;
+}
+
+Program::~Program()
+{
+    if (program_ != 0) {
+        glDeleteProgram(program_);
+        counter.release(0);
+    }
+}
+
+GLint Program::uniform_location(const std::string &name) const
+{
+    auto it = uniform_locations_.find(name);
+    if (it == uniform_locations_.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+void Program::cache_uniform_locations()
+{
+    GLint uniform_count = 0;
+    GLint max_name_length = 0;
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+    std::vector<GLchar> name(max_name_length);
+    for (GLint i=0; i<uniform_count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program_, i, max_name_length, &length, &size, &type, name.data());
+        uniform_locations_[std::string(name.data(), length)] = glGetUniformLocation(program_, name.data());
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <game/resource_counter.h>
+
+namespace render {
+
+    class Shader {
+    public:
+        enum ShaderType {
+            Vertex = GL_VERTEX_SHADER,
+            Fragment = GL_FRAGMENT_SHADER
+        };
+
+        virtual ~Shader();
+
+        /**
+         * @brief counter counts the live shader objects
+         */
+        static game::ResourceCounter counter;
+
+        GLuint gl_ref() const
+        {
+            return shader_;
+        }
+
+    protected:
+        Shader(ShaderType shaderType, const GLchar* shaderSource);
+
+    private:
+        ShaderType shader_type_;
+        const GLchar *shader_source_;
+        GLuint shader_;
+    };
+
+
+    class VertexShader: public Shader {
+    public:
+        VertexShader(const GLchar* shaderSource)
+            :Shader(ShaderType::Vertex, shaderSource)
+        {
+        }
+    };
+
+
+    class FragmentShader: public Shader {
+    public:
+        FragmentShader(const GLchar* shaderSource)
+            :Shader(ShaderType::Fragment, shaderSource)
+        {
+        }
+    };
+
+
+    class Program {
+    public:
+        /**
+         * @brief Program links the given shaders, which may be deleted afterwards
+         */
+        Program(const std::vector<Shader*> &shaders);
+
+        Program(const Program &) = delete;
+        Program &operator=(const Program &) = delete;
+
+        /**
+         * @brief counter counts the live program objects
+         */
+        static game::ResourceCounter counter;
+        /**
+         * @brief attachments counts the shaders attached to programs, which keep the driver from
+         * freeing them, it is back to zero once every program is linked
+         */
+        static game::ResourceCounter attachments;
+
+        /**
+         * @brief from_binary recreates a program from a binary of binary()
+         * @return the program, or nullptr if the driver rejects the binary
+         */
+        static std::unique_ptr<Program> from_binary(GLenum format, const std::vector<char> &binary);
+
+        /**
+         * @brief binary_supported tells whether the context can save and load program binaries
+         */
+        static bool binary_supported();
+
+        GLuint gl_ref()
+        {
+            return program_;
+        }
+
+        bool linked() const
+        {
+            return linked_;
+        }
+
+        /**
+         * @brief binary retrieves the linked program in the driver specific format
+         * @return false if the program is not linked or the driver does not provide a binary
+         */
+        bool binary(GLenum &format, std::vector<char> &binary) const;
+
+        /**
+         * @brief uniform_location looks up a uniform in the cache filled at link time
+         * @param name the name of the uniform as declared in the shader source
+         * @return the location of the uniform, or -1 if the program has no such active uniform
+         */
+        GLint uniform_location(const std::string &name) const;
+
+        virtual ~Program();
+
+    private:
+        Program();
+
+        bool check_link_status();
+        void cache_uniform_locations();
+
+        GLuint program_;
+        bool linked_;
+        std::unordered_map<std::string, GLint> uniform_locations_;
+    };
+
+}
+
+#endif // SHADER_H
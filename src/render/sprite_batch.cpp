@@ -0,0 +1,160 @@
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+using namespace render;
+
+namespace {
+
+const GLchar* spriteVertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec2 position;\n"
+    "layout (location = 1) in vec2 texCoord;\n"
+    "layout (location = 2) in vec4 color;\n"
+    "uniform mat4 viewMatrix;\n"
+    "out vec2 fragTexCoord;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "gl_Position = viewMatrix * vec4(position, 0.0, 1.0);\n"
+    "fragTexCoord = texCoord;\n"
+    "fragColor = color;\n"
+    "}\0";
+const GLchar* spriteFragmentShaderSource = "#version 330 core\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D atlas;\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "color = texture(atlas, fragTexCoord) * fragColor;\n"
+    "}\n\0";
+
+}
+
+SpriteBatch::SpriteBatch(int capacity)
+    : capacity_(capacity),
+      draw_calls_(0),
+      program_(ProgramCache::shared().get(spriteVertexShaderSource, spriteFragmentShaderSource))
+{
+    viewMatrixLocation_ = program_->uniform_location("viewMatrix");
+    atlasLocation_ = program_->uniform_location("atlas");
+    vertices_.reserve(4 * capacity_);
+
+    // the index pattern is the same for every quad, so it is generated once for the capacity
+    std::vector<GLuint> indices;
+    indices.reserve(6 * capacity_);
+    for (GLuint quad=0; quad<static_cast<GLuint>(capacity_); ++quad) {
+        const GLuint first = 4 * quad;
+        const GLuint pattern[] = {first, first + 1, first + 2, first + 2, first + 3, first};
+        indices.insert(indices.end(), pattern, pattern + 6);
+    }
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ibo_);
+    glBindVertexArray(vao_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, 4 * capacity_ * sizeof(Vertex), nullptr, GL_STREAM_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (GLvoid*)offsetof(Vertex, color));
+    glEnableVertexAttribArray(2);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+}
+
+SpriteBatch::~SpriteBatch()
+{
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &ibo_);
+    glDeleteBuffers(1, &vbo_);
+}
+
+void SpriteBatch::begin(const glm::mat4 &viewMatrix)
+{
+    viewMatrix_ = viewMatrix;
+    sprites_.clear();
+}
+
+void SpriteBatch::draw(const TextureAtlas &atlas, int region, GLfloat x, GLfloat y, GLfloat width, GLfloat height,
+                       int quarter_turns, int layer, std::uint32_t color)
+{
+    Sprite sprite;
+    sprite.key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(layer) ^ 0x80000000u) << 32) | atlas.gl_ref();
+    sprite.sequence = static_cast<std::uint32_t>(sprites_.size());
+    sprite.atlas = &atlas;
+    sprite.region = region;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.width = width;
+    sprite.height = height;
+    sprite.quarter_turns = quarter_turns & 3;
+    sprite.color = color;
+    sprites_.push_back(sprite);
+}
+
+void SpriteBatch::end(RenderQueue &queue, int layer)
+{
+    draw_calls_ = 0;
+    if (sprites_.empty()) {
+        return;
+    }
+    // unlike std::stable_sort, std::sort does not need a temporary buffer every frame
+    std::sort(sprites_.begin(), sprites_.end(), [](const Sprite &a, const Sprite &b) {
+        return a.key < b.key || (a.key == b.key && a.sequence < b.sequence);
+    });
+
+    vertices_.clear();
+    std::size_t run_begin = 0;
+    std::uint64_t key = sprites_.front().key;
+    const TextureAtlas *atlas = sprites_.front().atlas;
+    for (const Sprite &sprite : sprites_) {
+        if (sprite.key != key || vertices_.size() - run_begin == 4 * static_cast<std::size_t>(capacity_)) {
+            add_run(queue, layer, *atlas, run_begin);
+            if (sprite.key >> 32 != key >> 32) {
+                ++layer;
+            }
+            run_begin = vertices_.size();
+            key = sprite.key;
+            atlas = sprite.atlas;
+        }
+        const TextureAtlas::Region &region = sprite.atlas->region(sprite.region);
+        // texture coordinates of the corners counter-clockwise from the bottom left,
+        // rotating the image shifts which corner of the quad they are assigned to
+        const GLfloat u[] = {region.u0, region.u1, region.u1, region.u0};
+        const GLfloat v[] = {region.v1, region.v1, region.v0, region.v0};
+        const GLfloat x[] = {sprite.x, sprite.x + sprite.width, sprite.x + sprite.width, sprite.x};
+        const GLfloat y[] = {sprite.y, sprite.y, sprite.y + sprite.height, sprite.y + sprite.height};
+        for (int corner=0; corner<4; ++corner) {
+            const int uv = (corner + 4 - sprite.quarter_turns) % 4;
+            Vertex vertex = {x[corner], y[corner], u[uv], v[uv], sprite.color};
+            vertices_.push_back(vertex);
+        }
+    }
+    add_run(queue, layer, *atlas, run_begin);
+
+    // orphan the buffer so the driver does not wait for draws that still read the old contents,
+    // all runs share the upload and select their vertices by base vertex
+    const std::size_t size = std::max(vertices_.size(), 4 * static_cast<std::size_t>(capacity_)) * sizeof(Vertex);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_.size() * sizeof(Vertex), vertices_.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::add_run(RenderQueue &queue, int layer, const TextureAtlas &atlas, std::size_t first)
+{
+    const GLsizei quads = static_cast<GLsizei>((vertices_.size() - first) / 4);
+    queue.add(layer, program_->gl_ref(), vao_, atlas.gl_ref(), true,
+              DrawCall::elements(GL_TRIANGLES, 6 * quads, static_cast<GLint>(first)));
+    queue.set_uniform(viewMatrixLocation_, viewMatrix_);
+    queue.set_uniform(atlasLocation_, 0);
+    ++draw_calls_;
+}
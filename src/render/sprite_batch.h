@@ -0,0 +1,110 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "program_cache.h"
+#include "render_queue.h"
+#include "texture_atlas.h"
+
+namespace render {
+
+    /**
+     * @brief The SpriteBatch class collects textured quads and draws them in as few calls
+     * as possible
+     *
+     * Sprites submitted between begin() and end() are sorted by layer and then by atlas,
+     * keeping submission order for equal keys, and streamed into one vertex buffer. Every run
+     * of sprites sharing a layer and an atlas is queued as one draw, or more if it exceeds the
+     * capacity, which bounds the quads of one draw. When everything lives in one atlas, a whole
+     * frame costs one draw call per layer.
+     */
+    class SpriteBatch
+    {
+    public:
+        explicit SpriteBatch(int capacity = 16384);
+        ~SpriteBatch();
+
+        SpriteBatch(const SpriteBatch &) = delete;
+        SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+        void begin(const glm::mat4 &viewMatrix);
+
+        /**
+         * @brief draw queues a sprite for the current batch
+         * @param x the left edge of the sprite in world units
+         * @param y the bottom edge of the sprite in world units
+         * @param quarter_turns counter-clockwise rotation of the image in steps of 90 degrees
+         * @param layer sprites of lower layers are drawn first
+         * @param color multiplied with the texture, as 0xAABBGGRR
+         */
+        void draw(const TextureAtlas &atlas, int region, GLfloat x, GLfloat y, GLfloat width, GLfloat height,
+                  int quarter_turns = 0, int layer = 0, std::uint32_t color = 0xffffffff);
+
+        /**
+         * @brief end uploads the sprites of the batch and queues their draws
+         *
+         * The sprites of the lowest sprite layer go to the given queue layer, every further
+         * sprite layer to the next queue layer, so the queue keeps them in order.
+         */
+        void end(RenderQueue &queue, int layer);
+
+        /**
+         * @brief draw_calls tells how many draw calls the last end() queued
+         */
+        int draw_calls() const {
+            return draw_calls_;
+        }
+    private:
+        struct Sprite {
+            std::uint64_t key;
+            // submission order, which breaks ties of the key
+            std::uint32_t sequence;
+            const TextureAtlas *atlas;
+            int region;
+            GLfloat x;
+            GLfloat y;
+            GLfloat width;
+            GLfloat height;
+            int quarter_turns;
+            std::uint32_t color;
+        };
+
+        struct Vertex {
+            GLfloat x;
+            GLfloat y;
+            GLfloat u;
+            GLfloat v;
+            std::uint32_t color;
+        };
+
+        /**
+         * @brief add_run queues the draw of the vertices from first on
+         */
+        void add_run(RenderQueue &queue, int layer, const TextureAtlas &atlas, std::size_t first);
+
+        int capacity_;
+        int draw_calls_;
+        glm::mat4 viewMatrix_;
+        std::vector<Sprite> sprites_;
+        std::vector<Vertex> vertices_;
+
+        std::shared_ptr<Program> program_;
+        GLint viewMatrixLocation_;
+        GLint atlasLocation_;
+        GLuint vao_;
+        GLuint vbo_;
+        GLuint ibo_;
+    };
+
+}
+
+#endif // SPRITE_BATCH_H
@@ -0,0 +1,166 @@
+#include "sprites.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace render;
+
+namespace {
+
+struct Color {
+    std::uint8_t r, g, b, a;
+};
+
+class Image {
+public:
+    Image(int width, int height, Color fill)
+        : width_(width),
+          height_(height),
+          pixels_(width * height * 4)
+    {
+        for (int y=0; y<height_; ++y) {
+            for (int x=0; x<width_; ++x) {
+                set(x, y, fill);
+            }
+        }
+    }
+
+    void set(int x, int y, Color color)
+    {
+        std::uint8_t *pixel = &pixels_[(y * width_ + x) * 4];
+        pixel[0] = color.r;
+        pixel[1] = color.g;
+        pixel[2] = color.b;
+        pixel[3] = color.a;
+    }
+
+    void fill(int x0, int y0, int x1, int y1, Color color)
+    {
+        for (int y=y0; y<y1; ++y) {
+            for (int x=x0; x<x1; ++x) {
+                set(x, y, color);
+            }
+        }
+    }
+
+    int add_to(TextureAtlas &atlas) const
+    {
+        return atlas.add(width_, height_, pixels_.data());
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<std::uint8_t> pixels_;
+};
+
+const int cell_pixels = 16;
+
+Image floorImage()
+{
+    Image image(cell_pixels, cell_pixels, {0, 0, 0, 255});
+    return image;
+}
+
+Image clayImage()
+{
+    // bricks with mortar lines, every other row shifted by half a brick
+    Image image(cell_pixels, cell_pixels, {178, 102, 51, 255});
+    const Color mortar = {120, 120, 120, 255};
+    for (int row=0; row<cell_pixels; row+=4) {
+        image.fill(0, row + 3, cell_pixels, row + 4, mortar);
+        const int shift = (row / 4) % 2 == 0 ? 0 : 4;
+        for (int x=shift; x<cell_pixels; x+=8) {
+            image.fill(x, row, x + 1, row + 3, mortar);
+        }
+    }
+    return image;
+}
+
+Image wallImage()
+{
+    Image image(cell_pixels, cell_pixels, {153, 153, 153, 255});
+    const Color light = {230, 230, 230, 255};
+    const Color dark = {90, 90, 90, 255};
+    for (int block=0; block<cell_pixels; block+=8) {
+        image.fill(block, 0, block + 8, 1, light);
+        image.fill(block, 0, block + 1, cell_pixels, light);
+        image.fill(block + 7, 0, block + 8, cell_pixels, dark);
+    }
+    image.fill(0, cell_pixels - 1, cell_pixels, cell_pixels, dark);
+    return image;
+}
+
+Image rockImage()
+{
+    Image image(cell_pixels, cell_pixels, {77, 77, 77, 255});
+    const Color speck = {110, 110, 110, 255};
+    for (int i=0; i<cell_pixels * 3; ++i) {
+        image.set((i * 7) % cell_pixels, (i * 11) % cell_pixels, speck);
+    }
+    return image;
+}
+
+Image waterImage()
+{
+    Image image(cell_pixels, cell_pixels, {26, 77, 230, 255});
+    const Color wave = {120, 170, 255, 255};
+    for (int row=2; row<cell_pixels; row+=5) {
+        for (int x=0; x<cell_pixels; ++x) {
+            image.set(x, row + ((x / 2) % 2), wave);
+        }
+    }
+    return image;
+}
+
+Image tankImage()
+{
+    // drawn pointing up: two tracks, a hull and a barrel
+    Image image(cell_pixels, cell_pixels, {0, 0, 0, 0});
+    const Color track = {60, 60, 30, 255};
+    const Color hull = {220, 190, 60, 255};
+    image.fill(1, 2, 5, 15, track);
+    image.fill(11, 2, 15, 15, track);
+    image.fill(5, 4, 11, 13, hull);
+    image.fill(7, 0, 9, 7, hull);
+    return image;
+}
+
+Image bulletImage()
+{
+    Image image(4, 4, {255, 255, 255, 255});
+    image.set(0, 0, {0, 0, 0, 0});
+    image.set(3, 0, {0, 0, 0, 0});
+    image.set(0, 3, {0, 0, 0, 0});
+    image.set(3, 3, {0, 0, 0, 0});
+    return image;
+}
+
+Image pickupImage()
+{
+    // a diamond on a transparent background
+    Image image(cell_pixels, cell_pixels, {0, 0, 0, 0});
+    const Color gem = {240, 60, 200, 255};
+    for (int y=0; y<cell_pixels; ++y) {
+        const int half_width = y < cell_pixels / 2 ? y : cell_pixels - 1 - y;
+        image.fill(cell_pixels / 2 - 1 - half_width, y, cell_pixels / 2 + 1 + half_width, y + 1, gem);
+    }
+    return image;
+}
+
+}
+
+SpriteSheet render::buildSpriteSheet(TextureAtlas &atlas)
+{
+    SpriteSheet sheet;
+    sheet.cells[game::Map::Floor] = floorImage().add_to(atlas);
+    sheet.cells[game::Map::Clay] = clayImage().add_to(atlas);
+    sheet.cells[game::Map::Wall] = wallImage().add_to(atlas);
+    sheet.cells[game::Map::Rock] = rockImage().add_to(atlas);
+    sheet.cells[game::Map::Water] = waterImage().add_to(atlas);
+    sheet.tank = tankImage().add_to(atlas);
+    sheet.bullet = bulletImage().add_to(atlas);
+    sheet.pickup = pickupImage().add_to(atlas);
+    atlas.upload();
+    return sheet;
+}
@@ -0,0 +1,29 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <game/map.h>
+
+#include "texture_atlas.h"
+
+namespace render {
+
+    /**
+     * @brief The SpriteSheet struct maps the game's sprites to their atlas regions
+     */
+    struct SpriteSheet {
+        int cells[game::Map::Water + 1];
+        int tank;
+        int bullet;
+        int pickup;
+    };
+
+    /**
+     * @brief buildSpriteSheet draws the built-in pixel art into an atlas and uploads it
+     *
+     * Cells are 16x16 pixels, tanks 16x16 pointing up, bullets 4x4 and pickups 16x16.
+     */
+    SpriteSheet buildSpriteSheet(TextureAtlas &atlas);
+
+}
+
+#endif // SPRITES_H
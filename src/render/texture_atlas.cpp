@@ -0,0 +1,67 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+
+using namespace render;
+
+constexpr int TextureAtlas::padding;
+
+TextureAtlas::TextureAtlas(int width, int height)
+    : width_(width),
+      height_(height),
+      cursor_x_(padding),
+      cursor_y_(padding),
+      shelf_height_(0),
+      pixels_(width * height * 4, 0),
+      texture_(0)
+{
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    glDeleteTextures(1, &texture_);
+}
+
+int TextureAtlas::add(int width, int height, const std::uint8_t *rgba)
+{
+    if (cursor_x_ + width + padding > width_) {
+        cursor_x_ = padding;
+        cursor_y_ += shelf_height_ + padding;
+        shelf_height_ = 0;
+    }
+    if (cursor_x_ + width + padding > width_ || cursor_y_ + height + padding > height_) {
+        return -1;
+    }
+
+    for (int i=0; i<height; ++i) {
+        std::copy(rgba + i * width * 4, rgba + (i + 1) * width * 4,
+                  pixels_.begin() + ((cursor_y_ + i) * width_ + cursor_x_) * 4);
+    }
+
+    Region region;
+    region.u0 = static_cast<GLfloat>(cursor_x_) / width_;
+    region.v0 = static_cast<GLfloat>(cursor_y_) / height_;
+    region.u1 = static_cast<GLfloat>(cursor_x_ + width) / width_;
+    region.v1 = static_cast<GLfloat>(cursor_y_ + height) / height_;
+    regions_.push_back(region);
+
+    cursor_x_ += width + padding;
+    shelf_height_ = std::max(shelf_height_, height);
+    return static_cast<int>(regions_.size()) - 1;
+}
+
+void TextureAtlas::upload()
+{
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, pixels_.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,72 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <cstdint>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace render {
+
+    /**
+     * @brief The TextureAtlas class packs many small RGBA images into one texture
+     *
+     * Images are placed on shelves from left to right and top to bottom, separated by one
+     * pixel of padding. The atlas keeps a CPU copy of its pixels, upload() transfers it to
+     * the GL texture, which is sampled with nearest filtering for the pixel art look.
+     */
+    class TextureAtlas
+    {
+    public:
+        /**
+         * @brief The Region struct holds the texture coordinates of one packed image
+         */
+        struct Region {
+            GLfloat u0;
+            GLfloat v0;
+            GLfloat u1;
+            GLfloat v1;
+        };
+
+        TextureAtlas(int width, int height);
+        ~TextureAtlas();
+
+        TextureAtlas(const TextureAtlas &) = delete;
+        TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+        /**
+         * @brief add copies an image into the atlas
+         * @param rgba width * height pixels with four bytes each, rows from top to bottom
+         * @return the id of the region the image was placed at, or -1 if the atlas is full
+         */
+        int add(int width, int height, const std::uint8_t *rgba);
+
+        /**
+         * @brief upload transfers the pixels added so far to the GL texture
+         */
+        void upload();
+
+        const Region &region(int id) const {
+            return regions_[id];
+        }
+
+        GLuint gl_ref() const {
+            return texture_;
+        }
+    private:
+        static constexpr int padding = 1;
+
+        int width_;
+        int height_;
+        int cursor_x_;
+        int cursor_y_;
+        int shelf_height_;
+        std::vector<std::uint8_t> pixels_;
+        std::vector<Region> regions_;
+        GLuint texture_;
+    };
+
+}
+
+#endif // TEXTURE_ATLAS_H
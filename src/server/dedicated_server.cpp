@@ -0,0 +1,133 @@
+#include "dedicated_server.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace server;
+
+namespace {
+    // bots keep their buttons for this many ticks
+    const std::uint64_t bot_ticks = 32;
+
+    std::uint32_t xorshift(std::uint32_t &state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+DedicatedServer::Match::Match(const game::Map &level, int bot_count)
+    : world(level),
+      lockstep(world),
+      random(0),
+      ticks(0),
+      seconds(0.0)
+{
+    for (int i=0; i<bot_count; ++i) {
+        const int bot = lockstep.add_local_player();
+        if (bot < 0) {
+            break;
+        }
+        bots.push_back(bot);
+    }
+    // the match is not moved, it is owned by a std::unique_ptr of the server
+    lockstep.set_tick_handler([this](std::uint64_t tick) {
+        if (tick % bot_ticks != 0) {
+            return;
+        }
+        for (int bot : bots) {
+            lockstep.set_local_input(bot, static_cast<std::uint8_t>(xorshift(random) & (game::ButtonFire * 2 - 1)));
+        }
+    });
+}
+
+DedicatedServer::DedicatedServer(const game::Map &level, int match_count, int bots_per_match, int thread_count)
+    : pool_(thread_count)
+{
+    for (int i=0; i<match_count; ++i) {
+        matches_.emplace_back(new Match(level, bots_per_match));
+        matches_.back()->random = 0x9e3779b9u ^ static_cast<std::uint32_t>(i + 1);
+    }
+}
+
+bool DedicatedServer::open(std::uint16_t base_port)
+{
+    for (std::size_t i=0; i<matches_.size(); ++i) {
+        const std::uint16_t port = base_port == 0 ? 0 : static_cast<std::uint16_t>(base_port + i);
+        if (!matches_[i]->lockstep.open(port)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DedicatedServer::start_recording()
+{
+    for (const std::unique_ptr<Match> &match : matches_) {
+        match->recorder.reset(new game::ReplayRecorder(match->world));
+        match->lockstep.set_recorder(match->recorder.get());
+    }
+}
+
+bool DedicatedServer::save_recordings(const std::string &prefix) const
+{
+    bool saved = true;
+    for (std::size_t i=0; i<matches_.size(); ++i) {
+        if (!matches_[i]->recorder) {
+            continue;
+        }
+        const std::string path = prefix + "-" + std::to_string(i) + ".replay";
+        if (!matches_[i]->recorder->save(path, matches_[i]->world)) {
+            std::cerr << "could not write replay " << path << "\n";
+            saved = false;
+        }
+    }
+    return saved;
+}
+
+void DedicatedServer::update(int due_ticks)
+{
+    for (const std::unique_ptr<Match> &match : matches_) {
+        Match *running = match.get();
+        pool_.submit([running, due_ticks] {
+            run(*running, due_ticks);
+        });
+    }
+    pool_.wait();
+}
+
+void DedicatedServer::run(Match &match, int due_ticks)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+    match.ticks += match.lockstep.update(due_ticks);
+    match.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int DedicatedServer::client_count() const
+{
+    int count = 0;
+    for (const std::unique_ptr<Match> &match : matches_) {
+        count += match->lockstep.client_count();
+    }
+    return count;
+}
+
+std::uint64_t DedicatedServer::ticks() const
+{
+    std::uint64_t count = 0;
+    for (const std::unique_ptr<Match> &match : matches_) {
+        count += match->ticks;
+    }
+    return count;
+}
+
+double DedicatedServer::busy_seconds() const
+{
+    double seconds = 0.0;
+    for (const std::unique_ptr<Match> &match : matches_) {
+        seconds += match->seconds;
+    }
+    return seconds;
+}
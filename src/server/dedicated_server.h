@@ -0,0 +1,103 @@
+#ifndef DEDICATED_SERVER_H
+#define DEDICATED_SERVER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <game/map.h>
+#include <game/replay.h>
+#include <game/worker_pool.h>
+#include <game/world.h>
+
+#include <net/lockstep_server.h>
+
+namespace server {
+
+    /**
+     * @brief The DedicatedServer class runs many independent matches in one process
+     *
+     * Every match owns a World on its own copy of the level and a LockstepServer on a port of
+     * its own. update() hands each match to the WorkerPool as one job and waits for all of
+     * them, so a match is only ever touched by one thread at a time and needs no locking,
+     * while the matches of a process spread over all threads of the pool.
+     *
+     * Matches can have bots, local players that change their buttons at random every half
+     * second, so a server can be loaded without clients.
+     */
+    class DedicatedServer
+    {
+    public:
+        DedicatedServer(const game::Map &level, int match_count, int bots_per_match,
+                        int thread_count = game::WorkerPool::default_thread_count());
+
+        DedicatedServer(const DedicatedServer&) = delete;
+        DedicatedServer &operator=(const DedicatedServer&) = delete;
+
+        /**
+         * @brief open binds match i to base_port + i, or to any free port if base_port is 0
+         * @return false if a port could not be bound
+         */
+        bool open(std::uint16_t base_port);
+
+        /**
+         * @brief start_recording records a replay of every match from its current state on
+         */
+        void start_recording();
+        /**
+         * @brief save_recordings writes the replay of match i to prefix-i.replay
+         * @return false if a file could not be written
+         */
+        bool save_recordings(const std::string &prefix) const;
+
+        /**
+         * @brief update advances every match by the ticks that became due
+         */
+        void update(int due_ticks);
+
+        int match_count() const {
+            return static_cast<int>(matches_.size());
+        }
+        int thread_count() const {
+            return pool_.thread_count();
+        }
+        std::uint16_t port(int match) const {
+            return matches_[match]->lockstep.port();
+        }
+
+        /**
+         * @brief client_count is the number of clients connected to all matches
+         */
+        int client_count() const;
+        /**
+         * @brief ticks is the number of ticks simulated by all matches together
+         */
+        std::uint64_t ticks() const;
+        /**
+         * @brief busy_seconds is the time the jobs of all matches took together
+         */
+        double busy_seconds() const;
+
+    private:
+        struct Match {
+            Match(const game::Map &level, int bot_count);
+
+            game::World world;
+            net::LockstepServer lockstep;
+            std::vector<int> bots;
+            std::unique_ptr<game::ReplayRecorder> recorder;
+            std::uint32_t random;
+            std::uint64_t ticks;
+            double seconds;
+        };
+
+        static void run(Match &match, int due_ticks);
+
+        std::vector<std::unique_ptr<Match>> matches_;
+        game::WorkerPool pool_;
+    };
+
+}
+
+#endif // DEDICATED_SERVER_H
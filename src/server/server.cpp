@@ -0,0 +1,198 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <game/fixed_step.h>
+#include <game/map.h>
+#include <game/replay.h>
+#include <game/resource_counter.h>
+#include <game/worker_pool.h>
+#include <game/world.h>
+
+#include "dedicated_server.h"
+
+namespace {
+    volatile std::sig_atomic_t stop_requested = 0;
+
+    void requestStop(int) {
+        stop_requested = 1;
+    }
+}
+
+/**
+ * @brief The ServerOptions struct holds the command line configuration of the server
+ *
+ * Every match plays level, or an empty map of map_size if no level is given, and listens
+ * on port + its index, on any free port if port is 0. seconds limits the run time, the
+ * server runs until interrupted otherwise and then prints how busy its threads were.
+ * With record, match i is saved as the replay record-i.replay on exit.
+ *
+ * replay plays a replay file instead of running matches, as fast as possible unless
+ * realtime is set, and checks that it ends in the recorded state.
+ */
+struct ServerOptions {
+    int matches = 16;
+    int bots = 2;
+    int threads = game::WorkerPool::default_thread_count();
+    int port = 0;
+    std::string level;
+    int map_size = 26;
+    double seconds = 0.0;
+    std::string record;
+    std::string replay;
+    bool realtime = false;
+};
+
+/**
+ * @brief parseServerOptions reads the server options from the command line
+ *
+ * Recognized arguments are --matches=N, --bots=N, --threads=N, --port=P, --level=FILE,
+ * --size=N, --seconds=S, --record=PREFIX, --replay=FILE and --realtime.
+ */
+ServerOptions parseServerOptions(int argc, char *argv[])
+{
+    ServerOptions options;
+    for (int i=1; i<argc; ++i) {
+        if (std::strncmp(argv[i], "--matches=", 10) == 0 && std::atoi(argv[i] + 10) > 0) {
+            options.matches = std::atoi(argv[i] + 10);
+        } else if (std::strncmp(argv[i], "--bots=", 7) == 0 && std::atoi(argv[i] + 7) >= 0) {
+            options.bots = std::atoi(argv[i] + 7);
+        } else if (std::strncmp(argv[i], "--threads=", 10) == 0 && std::atoi(argv[i] + 10) > 0) {
+            options.threads = std::atoi(argv[i] + 10);
+        } else if (std::strncmp(argv[i], "--port=", 7) == 0 && std::atoi(argv[i] + 7) > 0) {
+            options.port = std::atoi(argv[i] + 7);
+        } else if (std::strncmp(argv[i], "--level=", 8) == 0) {
+            options.level = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--size=", 7) == 0 && std::atoi(argv[i] + 7) > 0) {
+            options.map_size = std::atoi(argv[i] + 7);
+        } else if (std::strncmp(argv[i], "--seconds=", 10) == 0 && std::atof(argv[i] + 10) > 0.0) {
+            options.seconds = std::atof(argv[i] + 10);
+        } else if (std::strncmp(argv[i], "--record=", 9) == 0) {
+            options.record = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--replay=", 9) == 0) {
+            options.replay = argv[i] + 9;
+        } else if (std::strcmp(argv[i], "--realtime") == 0) {
+            options.realtime = true;
+        } else {
+            std::cerr << "ignoring unknown argument " << argv[i] << "\n";
+        }
+    }
+    return options;
+}
+
+/**
+ * @brief playReplay simulates a replay without rendering
+ *
+ * Played as fast as possible this is a benchmark of the simulation on a real match, and
+ * comparing the final state to the recording detects lost determinism.
+ * @return the exit code, 1 if the replay is invalid or ended in a different state
+ */
+int playReplay(const ServerOptions &options)
+{
+    std::unique_ptr<game::Replay> replay = game::Replay::load(options.replay);
+    if (!replay) {
+        std::cerr << "could not load replay " << options.replay << "\n";
+        return 1;
+    }
+    typedef std::chrono::steady_clock Clock;
+    game::World world = replay->start();
+    game::FixedStep step(game::World::tick_seconds);
+    const Clock::time_point start = Clock::now();
+    Clock::time_point previous_time = start;
+    bool playing = true;
+    while (playing && !stop_requested) {
+        if (!options.realtime) {
+            playing = replay->step(world);
+            continue;
+        }
+        const Clock::time_point now = Clock::now();
+        for (int ticks = step.advance(std::chrono::duration<double>(now - previous_time).count());
+             ticks > 0 && playing; --ticks) {
+            playing = replay->step(world);
+        }
+        previous_time = now;
+        std::this_thread::sleep_for(std::chrono::duration<double>(step.step_seconds() * (1.0 - step.alpha())));
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << replay->position() << " of " << replay->tick_count() << " ticks in " << elapsed << " s, "
+              << (elapsed > 0.0 ? replay->position() / elapsed : 0.0) << " ticks per second\n";
+    if (replay->position() < replay->tick_count()) {
+        return 0;
+    }
+    if (game::stateHash(world) != replay->final_hash()) {
+        std::cerr << "the replay ended in a different state than it was recorded with\n";
+        return 1;
+    }
+    std::cout << "final state matches the recording\n";
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const ServerOptions options = parseServerOptions(argc, argv);
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    if (!options.replay.empty()) {
+        return playReplay(options);
+    }
+
+    std::unique_ptr<game::Map> level;
+    if (options.level.empty()) {
+        level.reset(new game::Map(options.map_size));
+    } else {
+        level = game::Map::load(options.level);
+        if (!level) {
+            std::cerr << "could not load level " << options.level << "\n";
+            return 1;
+        }
+    }
+
+    server::DedicatedServer matches(*level, options.matches, options.bots, options.threads);
+    if (!matches.open(static_cast<std::uint16_t>(options.port))) {
+        return 1;
+    }
+    for (int i=0; i<matches.match_count(); ++i) {
+        std::cout << "match " << i << " on port " << matches.port(i) << "\n";
+    }
+
+    if (!options.record.empty()) {
+        matches.start_recording();
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    game::FixedStep step(game::World::tick_seconds);
+    const Clock::time_point start = Clock::now();
+    Clock::time_point previous_time = start;
+    while (!stop_requested) {
+        const Clock::time_point now = Clock::now();
+        if (options.seconds > 0.0 && std::chrono::duration<double>(now - start).count() >= options.seconds) {
+            break;
+        }
+        matches.update(step.advance(std::chrono::duration<double>(now - previous_time).count()));
+        previous_time = now;
+        // sleep until the next tick is due
+        std::this_thread::sleep_for(std::chrono::duration<double>(step.step_seconds() * (1.0 - step.alpha())));
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    const double tick_cost = matches.ticks() > 0 ? matches.busy_seconds() / matches.ticks() : 0.0;
+    std::cout << matches.match_count() << " matches on " << matches.thread_count() << " threads, "
+              << matches.client_count() << " clients, " << matches.ticks() << " ticks in "
+              << elapsed << " s\n"
+              << tick_cost * 1e6 << " us per match tick, about "
+              << (tick_cost > 0.0 ? static_cast<long>(game::World::tick_seconds / tick_cost) : 0)
+              << " matches per core\n";
+    // the matches still exist, so this is the memory they hold
+    game::printResourceCounters(std::cout);
+    if (!options.record.empty() && !matches.save_recordings(options.record)) {
+        return 1;
+    }
+    return 0;
+}